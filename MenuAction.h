@@ -1,7 +1,11 @@
 #ifndef _MenuAction_h_
 # define _MenuAction_h_
 
-enum MENU_ACTION { MENU_ACTION_NONE, MENU_ACTION_UP, MENU_ACTION_DOWN, MENU_ACTION_SELECT, MENU_ACTION_BACK };
+//JUMP and SEEK take an argument in place of DoMenuAction's repeat count: the position to jump to,
+//counting from 1, and the letter to seek.  They are not meant for MenuActionQueue.
+enum MENU_ACTION { MENU_ACTION_NONE, MENU_ACTION_UP, MENU_ACTION_DOWN, MENU_ACTION_SELECT, MENU_ACTION_BACK,
+                   MENU_ACTION_PAGE_UP, MENU_ACTION_PAGE_DOWN, MENU_ACTION_FIRST, MENU_ACTION_LAST,
+                   MENU_ACTION_JUMP, MENU_ACTION_SEEK };
 typedef enum MENU_ACTION_RESULT { MENU_ACTION_RESULT_NONE, MENU_ACTION_RESULT_RETAIN_DISPLAY } MENU_ACTION_RESULT;
 
 #endif // __MenuAction_h__
@@ -0,0 +1,122 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MenuActionQueue_h
+#define MenuActionQueue_h 1
+
+#include <Arduino.h>
+#include "MenuAction.h"
+
+//A single producer / single consumer ring of MENU_ACTIONs.
+//push() may be called from one interrupt handler (e.g. a rotary encoder ISR) while loop()
+//pops, without disabling interrupts: the producer only writes m_head, the consumer only
+//writes m_tail, and both are single bytes so every load and store of them is atomic.
+//
+//SIZE must be a power of two no bigger than 128, the free running 8-bit indices wrap cleanly then.
+//When the ring is full push() drops the action and counts it, see getOverflowCount().
+template <uint8_t SIZE>
+class MenuActionQueue
+{
+  public:
+  MenuActionQueue(): m_head( 0 ), m_tail( 0 ), m_overflows( 0 ) {}
+
+  //Producer side, safe to call from an ISR.
+  bool push( MENU_ACTION action );
+  //Consumer side.  Returns false when the queue is empty.
+  bool pop( MENU_ACTION *pAction );
+  //Consumer side.  Looks at the next action without removing it.
+  bool peek( MENU_ACTION *pAction );
+  uint8_t getCount();
+  unsigned int getOverflowCount();
+  void resetOverflowCount();
+
+  private:
+  volatile uint8_t m_events[SIZE];
+  volatile uint8_t m_head;
+  volatile uint8_t m_tail;
+  volatile unsigned int m_overflows;
+  static_assert( SIZE > 0 && SIZE <= 128 && ( SIZE & ( SIZE - 1 ) ) == 0, "MenuActionQueue SIZE must be a power of two <= 128" );
+};
+
+template <uint8_t SIZE>
+bool MenuActionQueue<SIZE>::push( MENU_ACTION action )
+{
+  uint8_t head = m_head;
+  if( (uint8_t)( head - m_tail ) >= SIZE )
+  {
+    m_overflows = m_overflows + 1;
+    return false;
+  }
+  m_events[ head & ( SIZE - 1 ) ] = (uint8_t)action;
+  //publish the slot only after it has been written
+  m_head = head + 1;
+  return true;
+}
+
+template <uint8_t SIZE>
+bool MenuActionQueue<SIZE>::peek( MENU_ACTION *pAction )
+{
+  uint8_t tail = m_tail;
+  if( tail == m_head )
+  {
+    return false;
+  }
+  *pAction = (MENU_ACTION)m_events[ tail & ( SIZE - 1 ) ];
+  return true;
+}
+
+template <uint8_t SIZE>
+bool MenuActionQueue<SIZE>::pop( MENU_ACTION *pAction )
+{
+  if( !peek( pAction ) )
+  {
+    return false;
+  }
+  m_tail = m_tail + 1;
+  return true;
+}
+
+template <uint8_t SIZE>
+uint8_t MenuActionQueue<SIZE>::getCount()
+{
+  return (uint8_t)( m_head - m_tail );
+}
+
+template <uint8_t SIZE>
+unsigned int MenuActionQueue<SIZE>::getOverflowCount()
+{
+  //the counter is wider than a byte on AVR and the ISR may bump it mid-read, so read until stable
+  unsigned int count;
+  do
+  {
+    count = m_overflows;
+  } while( count != m_overflows );
+  return count;
+}
+
+template <uint8_t SIZE>
+void MenuActionQueue<SIZE>::resetOverflowCount()
+{
+  noInterrupts();
+  m_overflows = 0;
+  interrupts();
+}
+
+#endif
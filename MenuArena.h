@@ -0,0 +1,128 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuArena_h
+#define MenuArena_h 1
+
+#include <Arduino.h>
+#include <new>
+#include "MenuEntry.h"
+
+//Builds menu entries, and copies of their labels, one after another in a buffer you provide
+//instead of with new, so building a menu costs no malloc headers and leaves no holes in the heap:
+//
+//  uint8_t g_arenaBuffer[600];
+//  MenuArena g_arena( g_arenaBuffer, sizeof( g_arenaBuffer ) );
+//  ...
+//  menuController.addChild( g_arena.newEntry< MenuEntry<LiquidCrystal> >( "Start", NULL, StartCallback ) );
+//
+//Nothing is freed one by one.  getMark() and resetTo() drop everything made after a point, so a
+//submenu built last can be thrown away and built again, e.g. after a new network scan:
+//
+//  menuController.ClearChildren( pScanEntry );     //unhook it first
+//  g_arena.resetTo( s_scanMark );
+//  MenuEntry<LiquidCrystal> *pLast = NULL;
+//  for( int i = 0; i < nFound; ++i )
+//  {
+//    MenuEntry<LiquidCrystal> *p = g_arena.newEntry< MenuEntry<LiquidCrystal> >( ssids[i], NULL, JoinCallback );
+//    //addChild() walks the whole chain, adding after the last one is constant time
+//    if( pLast == NULL ) pScanEntry->addChild( p ); else pLast->addSibling( p );
+//    pLast = p;
+//  }
+//
+//Destructors are not run, which is fine for MenuEntry and anything else that owns no resources.
+class MenuArena
+{
+  public:
+  MenuArena( void *pBuffer, size_t size ): m_pBuffer( (uint8_t *)pBuffer ), m_size( size ), m_used( 0 ), m_highWater( 0 ) {}
+
+  //Returns NULL when the arena is full.
+  void *allocate( size_t size, size_t align = 1 );
+  //A copy of pText in the arena, so the label can come from a temporary buffer.
+  const char *copyText( const char *pText );
+  //A new ENTRY with a copy of menuText.  Returns NULL when the arena is full.
+  template <class ENTRY> ENTRY *newEntry( const char *menuText, void *userData, MENU_ACTION_CALLBACK_FUNC func );
+  //Flash labels are used where they are, only the entry goes in the arena.
+  template <class ENTRY> ENTRY *newEntry( const __FlashStringHelper *menuText, void *userData, MENU_ACTION_CALLBACK_FUNC func );
+
+  size_t getMark() { return m_used; }
+  //Frees everything allocated since getMark() returned mark.  Nothing may still point into it.
+  void resetTo( size_t mark ) { if( mark < m_used ) m_used = mark; }
+  void reset() { m_used = 0; }
+
+  size_t getSize() { return m_size; }
+  size_t getUsed() { return m_used; }
+  //The most that was ever in use, to size the buffer.
+  size_t getHighWater() { return m_highWater; }
+
+  private:
+  uint8_t *m_pBuffer;
+  size_t m_size;
+  size_t m_used;
+  size_t m_highWater;
+};
+
+inline void *MenuArena::allocate( size_t size, size_t align )
+{
+  size_t start = ( m_used + align - 1 ) & ~( align - 1 );
+  if( start > m_size || size > m_size - start )
+  {
+    return NULL;
+  }
+  m_used = start + size;
+  if( m_used > m_highWater )
+  {
+    m_highWater = m_used;
+  }
+  return m_pBuffer + start;
+}
+
+inline const char *MenuArena::copyText( const char *pText )
+{
+  size_t len = strlen( pText ) + 1;
+  char *pCopy = (char *)allocate( len );
+  if( pCopy != NULL )
+  {
+    memcpy( pCopy, pText, len );
+  }
+  return pCopy;
+}
+
+template <class ENTRY>
+ENTRY *MenuArena::newEntry( const char *menuText, void *userData, MENU_ACTION_CALLBACK_FUNC func )
+{
+  size_t mark = m_used;
+  const char *pText = copyText( menuText );
+  void *p = pText != NULL ? allocate( sizeof( ENTRY ), alignof( ENTRY ) ) : NULL;
+  if( p == NULL )
+  {
+    m_used = mark;
+    return NULL;
+  }
+  return new( p ) ENTRY( pText, userData, func );
+}
+
+template <class ENTRY>
+ENTRY *MenuArena::newEntry( const __FlashStringHelper *menuText, void *userData, MENU_ACTION_CALLBACK_FUNC func )
+{
+  void *p = allocate( sizeof( ENTRY ), alignof( ENTRY ) );
+  return p != NULL ? new( p ) ENTRY( menuText, userData, func ) : NULL;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuBind_h
+#define MenuBind_h 1
+
+#include <Arduino.h>
+#include "MenuAction.h"
+
+//Ready made callbacks whose target is fixed at compile time by template arguments, so the
+//entry needs no user data (pass NULL) and nothing is cast through void*.  Each one is an
+//ordinary MENU_ACTION_CALLBACK_FUNC, the compiler writes one small function per binding
+//with the value or call inlined into it.
+//
+//  new MenuEntry<LiquidCrystal>( "Fast", NULL, MenuAction_Set<Speed, &g_speed, SPEED_FAST> )
+//  new MenuEntry<LiquidCrystal>( "Light", NULL, MenuAction_Toggle<bool, &g_light> )
+//  new MenuEntry<LiquidCrystal>( "Reset", NULL, MenuAction_Call<&ResetCounters> )
+//  new MenuEntry<LiquidCrystal>( "Start", NULL, MenuAction_Call<Timer, &g_timer, &Timer::Start> )
+//  new MenuEntry<LiquidCrystal>( "Beep", NULL, MenuAction_Functor<Beep> )
+//
+//Functions, methods and functors may return void or a MENU_ACTION_RESULT.
+//For "Back" use MenuEntry_BackCallbackFunc<T> with NULL user data, MenuManager handles it itself.
+
+//Stores VALUE in *P.  V can be any type usable as a template argument: bool, an integer or an enum.
+template <class V, V *P, V VALUE>
+MENU_ACTION_RESULT MenuAction_Set( const char * pMenuText, void * pUserData )
+{
+  *P = VALUE;
+  return MENU_ACTION_RESULT_NONE;
+}
+
+//Flips *P between true and false.
+template <class V, V *P>
+MENU_ACTION_RESULT MenuAction_Toggle( const char * pMenuText, void * pUserData )
+{
+  *P = !*P;
+  return MENU_ACTION_RESULT_NONE;
+}
+
+//Calls a free function.
+template <void (*FUNC)()>
+MENU_ACTION_RESULT MenuAction_Call( const char * pMenuText, void * pUserData )
+{
+  FUNC();
+  return MENU_ACTION_RESULT_NONE;
+}
+
+template <MENU_ACTION_RESULT (*FUNC)()>
+MENU_ACTION_RESULT MenuAction_Call( const char * pMenuText, void * pUserData )
+{
+  return FUNC();
+}
+
+//Calls METHOD on the object at OBJ, which must have static storage.
+template <class C, C *OBJ, void (C::*METHOD)()>
+MENU_ACTION_RESULT MenuAction_Call( const char * pMenuText, void * pUserData )
+{
+  (OBJ->*METHOD)();
+  return MENU_ACTION_RESULT_NONE;
+}
+
+template <class C, C *OBJ, MENU_ACTION_RESULT (C::*METHOD)()>
+MENU_ACTION_RESULT MenuAction_Call( const char * pMenuText, void * pUserData )
+{
+  return (OBJ->*METHOD)();
+}
+
+template <class F>
+MENU_ACTION_RESULT MenuBindInvoke( F &f, void * )
+{
+  f();
+  return MENU_ACTION_RESULT_NONE;
+}
+
+template <class F>
+MENU_ACTION_RESULT MenuBindInvoke( F &f, MENU_ACTION_RESULT * )
+{
+  return f();
+}
+
+//Default constructs a stateless F and calls its operator().
+template <class F>
+MENU_ACTION_RESULT MenuAction_Functor( const char * pMenuText, void * pUserData )
+{
+  F f;
+  return MenuBindInvoke( f, (decltype( f() ) *)NULL );
+}
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MenuBusCounter_h
+#define MenuBusCounter_h 1
+
+#include <Arduino.h>
+
+//HD44780 execution times from the datasheet, in microseconds.
+#define MENU_HD44780_CLEAR_US   1520
+#define MENU_HD44780_COMMAND_US 37
+#define MENU_HD44780_DATA_US    41
+
+//What went over the display bus, and how long the controller needed for it.
+struct MenuBusStats
+{
+  unsigned long clears;        //clear() and home(), the slow commands
+  unsigned long cursorMoves;   //setCursor()
+  unsigned long chars;         //characters written to display memory
+  unsigned long scrolls;       //scrollDisplayLeft/Right()
+  unsigned long glyphUploads;  //createChar()
+  unsigned long commands;      //every bus transfer, commands and data
+  unsigned long busMicros;     //estimated controller busy time
+};
+
+//A display that does nothing, so MenuLCD and MenuManager can run without hardware,
+//e.g. on a PC or under a test harness: MenuLCD< MenuBusCounter<MenuNullLCD> >.
+class MenuNullLCD : public Print
+{
+  public:
+  void clear() {}
+  void home() {}
+  void setCursor( uint8_t col, uint8_t row ) {}
+  size_t write( uint8_t c ) { return 1; }
+  size_t write( const uint8_t *buffer, size_t size ) { return size; }
+  void scrollDisplayLeft() {}
+  void scrollDisplayRight() {}
+  void createChar( uint8_t location, uint8_t charmap[] ) {}
+};
+
+//Sits between MenuLCD and the real display and counts every call, so redraw costs can be
+//measured on the device or on a PC:
+//
+//  LiquidCrystal g_lcd( ... );
+//  MenuBusCounter<LiquidCrystal> g_counter( &g_lcd );
+//  MenuLCD< MenuBusCounter<LiquidCrystal> > g_menuLCD( &g_counter, 16, 2 );
+//
+//Everything is forwarded to the wrapped display unchanged.
+template <class T>
+class MenuBusCounter : public Print
+{
+  public:
+  MenuBusCounter( T *pLCD ): m_pLCD( pLCD ) { resetStats(); }
+
+  void clear() { m_pLCD->clear(); Count( m_stats.clears, MENU_HD44780_CLEAR_US ); }
+  void home() { m_pLCD->home(); Count( m_stats.clears, MENU_HD44780_CLEAR_US ); }
+  void setCursor( uint8_t col, uint8_t row ) { m_pLCD->setCursor( col, row ); Count( m_stats.cursorMoves, MENU_HD44780_COMMAND_US ); }
+  size_t write( uint8_t c ) { Count( m_stats.chars, MENU_HD44780_DATA_US ); return m_pLCD->write( c ); }
+  size_t write( const uint8_t *buffer, size_t size )
+  {
+    for( size_t i = 0; i < size; ++i )
+    {
+      Count( m_stats.chars, MENU_HD44780_DATA_US );
+    }
+    return m_pLCD->write( buffer, size );
+  }
+  void scrollDisplayLeft() { m_pLCD->scrollDisplayLeft(); Count( m_stats.scrolls, MENU_HD44780_COMMAND_US ); }
+  void scrollDisplayRight() { m_pLCD->scrollDisplayRight(); Count( m_stats.scrolls, MENU_HD44780_COMMAND_US ); }
+  void createChar( uint8_t location, uint8_t charmap[] )
+  {
+    m_pLCD->createChar( location, charmap );
+    //one address command and eight rows of data
+    m_stats.glyphUploads++;
+    m_stats.commands += 9;
+    m_stats.busMicros += MENU_HD44780_COMMAND_US + 8 * MENU_HD44780_DATA_US;
+  }
+
+  const MenuBusStats &getStats() { return m_stats; }
+  void resetStats() { memset( &m_stats, 0, sizeof( m_stats ) ); }
+  T *getLCD() { return m_pLCD; }
+
+  private:
+  void Count( unsigned long &counter, unsigned int iMicros )
+  {
+    counter++;
+    m_stats.commands++;
+    m_stats.busMicros += iMicros;
+  }
+
+  T *m_pLCD;
+  MenuBusStats m_stats;
+};
+
+#endif
@@ -0,0 +1,371 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuEditor_h
+#define MenuEditor_h 1
+
+#include <Arduino.h>
+#include <limits.h>
+
+//Room for the longest text an editor shows, "[255].255.255.255", and the terminator.
+#define MENU_EDIT_BUF_SIZE 18
+//Largest duration DoDurationInput accepts, 99:59:59.
+#define MENU_EDIT_MAX_SECONDS 359999L
+//Most digits after the point, so 10 to that power still fits in 32 bits.
+#define MENU_EDIT_MAX_DECIMALS 9
+
+//Writes an edited value back to the caller's variable.  MenuEditor_Store<V> does it for any
+//integer or enum type V.
+typedef void (*MENU_EDIT_STORE_FUNC)( void * pTarget, long lValue );
+
+template <class V>
+void MenuEditor_Store( void * pTarget, long lValue )
+{
+  *(V *)pTarget = (V)lValue;
+}
+
+//The state of one value being edited through the menu: a number (optionally shown as a fixed point
+//decimal), one of a list of choices, an HH:MM:SS duration or a row of 0-255 octets such as an IP address.
+//It is a plain member of MenuManager, so starting an edit never touches the heap.
+//
+//Durations and octets are edited one field at a time, the field being changed is shown in [brackets].
+//Every change is written straight to the caller's variable.
+class MenuEditor
+{
+  public:
+  typedef enum { NUMBER, CHOICE, DURATION, OCTETS } Kind;
+
+  MenuEditor();
+  //lStep is the change per step.  iDecimals > 0 shows the value with that many digits after
+  //the point, e.g. 1234 with 2 decimals is "12.34".  More than MENU_EDIT_MAX_DECIMALS are cut to that.
+  void SetNumber( long lMin, long lMax, long lStart, long lStep, uint8_t iDecimals, void * pTarget, MENU_EDIT_STORE_FUNC pStore );
+  //An empty list (iCount 0) shows nothing and never stores.
+  void SetChoice( const char * const * ppChoices, int iCount, int iStart, void * pTarget, MENU_EDIT_STORE_FUNC pStore );
+  void SetDuration( long lStartSeconds, void * pTarget, MENU_EDIT_STORE_FUNC pStore );
+  //Edits iCount bytes at pOctets in place, iCount at most 4.
+  void SetOctets( uint8_t * pOctets, int iCount );
+
+  //Moves the current field lCount steps.  Numbers stop at the last step that fits in the range.
+  void Increase( long lCount );
+  void Decrease( long lCount );
+  //Sets the current field to its smallest or largest value.
+  void First();
+  void Last();
+  //Moves to the next or previous field.  Returns false when there is none, which ends the edit.
+  bool NextField();
+  bool PrevField();
+
+  Kind getKind() { return m_kind; }
+  long getValue() { return m_lValue; }
+  //True once a step has changed the value since the last Set call.
+  bool isChanged() { return m_fChanged; }
+  //Writes the value as it should be shown, at most iSize - 1 characters.
+  void Format( char * pBuf, int iSize );
+
+  private:
+  static long Step( long lValue, long lMin, long lMax, long lStep, bool fUp, unsigned long ulSteps );
+  void Move( bool fUp, unsigned long ulSteps );
+  void getFieldRange( long * plMin, long * plMax, long * plUnit );
+  long getField();
+  void setField( long lField );
+  void Store();
+  static char *AppendNumber( char * pDest, char * pEnd, unsigned long ulValue, int iMinDigits );
+
+  Kind m_kind;
+  long m_lValue;
+  long m_lMin;
+  long m_lMax;
+  long m_lStep;
+  uint8_t m_iDecimals;
+  uint8_t m_iField;
+  uint8_t m_iFieldCount;
+  bool m_fChanged;
+  const char * const * m_ppChoices;
+  uint8_t * m_pOctets;
+  void * m_pTarget;
+  MENU_EDIT_STORE_FUNC m_pStore;
+};
+
+inline MenuEditor::MenuEditor():
+  m_kind( NUMBER ),
+  m_lValue( 0 ),
+  m_lMin( 0 ),
+  m_lMax( 0 ),
+  m_lStep( 1 ),
+  m_iDecimals( 0 ),
+  m_iField( 0 ),
+  m_iFieldCount( 1 ),
+  m_fChanged( false ),
+  m_ppChoices( NULL ),
+  m_pOctets( NULL ),
+  m_pTarget( NULL ),
+  m_pStore( NULL )
+{
+}
+
+inline void MenuEditor::SetNumber( long lMin, long lMax, long lStart, long lStep, uint8_t iDecimals, void * pTarget, MENU_EDIT_STORE_FUNC pStore )
+{
+  m_kind = NUMBER;
+  m_lMin = lMin;
+  m_lMax = lMax;
+  m_lValue = lStart < lMin ? lMin : ( lStart > lMax ? lMax : lStart );
+  m_lStep = lStep > 0 ? lStep : 1;
+  m_iDecimals = iDecimals > MENU_EDIT_MAX_DECIMALS ? MENU_EDIT_MAX_DECIMALS : iDecimals;
+  m_iField = 0;
+  m_iFieldCount = 1;
+  m_fChanged = false;
+  m_pTarget = pTarget;
+  m_pStore = pStore;
+  Store();
+}
+
+inline void MenuEditor::SetChoice( const char * const * ppChoices, int iCount, int iStart, void * pTarget, MENU_EDIT_STORE_FUNC pStore )
+{
+  if( iCount <= 0 )
+  {
+    //nothing to choose: show an empty row and leave the variable alone
+    SetNumber( 0, 0, 0, 1, 0, pTarget, NULL );
+    m_kind = CHOICE;
+    m_ppChoices = NULL;
+    return;
+  }
+  SetNumber( 0, iCount - 1, iStart, 1, 0, pTarget, pStore );
+  m_kind = CHOICE;
+  m_ppChoices = ppChoices;
+}
+
+inline void MenuEditor::SetDuration( long lStartSeconds, void * pTarget, MENU_EDIT_STORE_FUNC pStore )
+{
+  SetNumber( 0, MENU_EDIT_MAX_SECONDS, lStartSeconds, 1, 0, pTarget, pStore );
+  m_kind = DURATION;
+  m_iFieldCount = 3;
+}
+
+inline void MenuEditor::SetOctets( uint8_t * pOctets, int iCount )
+{
+  m_kind = OCTETS;
+  m_pOctets = pOctets;
+  m_iField = 0;
+  m_iFieldCount = iCount < 1 ? 1 : ( iCount > 4 ? 4 : iCount );
+  m_fChanged = false;
+  m_pTarget = NULL;
+  m_pStore = NULL;
+}
+
+//lValue moved ulSteps steps of lStep, stopping at the last step inside lMin..lMax.
+inline long MenuEditor::Step( long lValue, long lMin, long lMax, long lStep, bool fUp, unsigned long ulSteps )
+{
+  //unsigned so the distance between the ends of a full range long can't overflow
+  unsigned long ulRoom = fUp ? (unsigned long)lMax - (unsigned long)lValue : (unsigned long)lValue - (unsigned long)lMin;
+  if( ulSteps > ulRoom / lStep )
+  {
+    ulSteps = ulRoom / lStep;
+  }
+  return fUp ? (long)( (unsigned long)lValue + ulSteps * lStep ) : (long)( (unsigned long)lValue - ulSteps * lStep );
+}
+
+//The range of the current field and the number of seconds it is worth.
+inline void MenuEditor::getFieldRange( long * plMin, long * plMax, long * plUnit )
+{
+  *plMin = 0;
+  *plMax = m_iField == 0 ? 99 : 59;
+  *plUnit = m_iField == 0 ? 3600L : ( m_iField == 1 ? 60 : 1 );
+}
+
+inline long MenuEditor::getField()
+{
+  if( m_kind == OCTETS )
+  {
+    return m_pOctets[m_iField];
+  }
+  long lMin, lMax, lUnit;
+  getFieldRange( &lMin, &lMax, &lUnit );
+  return ( m_lValue / lUnit ) % ( lMax + 1 );
+}
+
+inline void MenuEditor::setField( long lField )
+{
+  if( m_kind == OCTETS )
+  {
+    m_pOctets[m_iField] = (uint8_t)lField;
+    return;
+  }
+  long lMin, lMax, lUnit;
+  getFieldRange( &lMin, &lMax, &lUnit );
+  m_lValue += ( lField - getField() ) * lUnit;
+  Store();
+}
+
+inline void MenuEditor::Store()
+{
+  if( m_pStore != NULL )
+  {
+    m_pStore( m_pTarget, m_lValue );
+  }
+}
+
+inline void MenuEditor::Move( bool fUp, unsigned long ulSteps )
+{
+  if( m_kind == NUMBER || m_kind == CHOICE )
+  {
+    long lValue = Step( m_lValue, m_lMin, m_lMax, m_lStep, fUp, ulSteps );
+    m_fChanged = m_fChanged || lValue != m_lValue;
+    m_lValue = lValue;
+    Store();
+  }
+  else
+  {
+    long lMin, lMax, lUnit;
+    getFieldRange( &lMin, &lMax, &lUnit );
+    if( m_kind == OCTETS )
+    {
+      lMax = 255;
+    }
+    long lField = getField();
+    long lNewField = Step( lField, lMin, lMax, 1, fUp, ulSteps );
+    m_fChanged = m_fChanged || lNewField != lField;
+    setField( lNewField );
+  }
+}
+
+inline void MenuEditor::Increase( long lCount )
+{
+  Move( lCount > 0, lCount > 0 ? (unsigned long)lCount : 0UL - (unsigned long)lCount );
+}
+
+inline void MenuEditor::Decrease( long lCount )
+{
+  Move( lCount < 0, lCount < 0 ? 0UL - (unsigned long)lCount : (unsigned long)lCount );
+}
+
+inline void MenuEditor::First()
+{
+  Move( false, ULONG_MAX );
+}
+
+inline void MenuEditor::Last()
+{
+  Move( true, ULONG_MAX );
+}
+
+inline bool MenuEditor::NextField()
+{
+  if( m_iField + 1 >= m_iFieldCount )
+  {
+    return false;
+  }
+  ++m_iField;
+  return true;
+}
+
+inline bool MenuEditor::PrevField()
+{
+  if( m_iField == 0 )
+  {
+    return false;
+  }
+  --m_iField;
+  return true;
+}
+
+//Appends ulValue in decimal, zero padded to iMinDigits, without passing pEnd.
+inline char *MenuEditor::AppendNumber( char * pDest, char * pEnd, unsigned long ulValue, int iMinDigits )
+{
+  //enough for a 64 bit unsigned long
+  char digits[20];
+  int n = 0;
+  do
+  {
+    digits[n++] = '0' + ulValue % 10;
+    ulValue /= 10;
+  } while( ( ulValue != 0 || n < iMinDigits ) && n < (int)sizeof( digits ) );
+  while( n > 0 && pDest < pEnd )
+  {
+    *pDest++ = digits[--n];
+  }
+  return pDest;
+}
+
+inline void MenuEditor::Format( char * pBuf, int iSize )
+{
+  char *p = pBuf;
+  char *pEnd = pBuf + iSize - 1;
+  if( m_kind == CHOICE )
+  {
+    if( m_ppChoices == NULL )
+    {
+      *pBuf = '\0';
+      return;
+    }
+    strncpy( pBuf, m_ppChoices[m_lValue], iSize - 1 );
+    pBuf[iSize - 1] = '\0';
+    return;
+  }
+  if( m_kind == NUMBER )
+  {
+    unsigned long ulAbs = m_lValue < 0 ? 0UL - (unsigned long)m_lValue : (unsigned long)m_lValue;
+    if( m_lValue < 0 && p < pEnd )
+    {
+      *p++ = '-';
+    }
+    if( m_iDecimals == 0 )
+    {
+      p = AppendNumber( p, pEnd, ulAbs, 1 );
+    }
+    else
+    {
+      unsigned long ulScale = 1;
+      for( int i = 0; i < m_iDecimals; ++i )
+      {
+        ulScale *= 10;
+      }
+      p = AppendNumber( p, pEnd, ulAbs / ulScale, 1 );
+      if( p < pEnd )
+      {
+        *p++ = '.';
+      }
+      p = AppendNumber( p, pEnd, ulAbs % ulScale, m_iDecimals );
+    }
+    *p = '\0';
+    return;
+  }
+  //durations and octets: fields with separators, the current one in brackets
+  uint8_t iSaveField = m_iField;
+  for( uint8_t i = 0; i < m_iFieldCount; ++i )
+  {
+    if( i > 0 && p < pEnd )
+    {
+      *p++ = m_kind == DURATION ? ':' : '.';
+    }
+    if( i == iSaveField && p < pEnd )
+    {
+      *p++ = '[';
+    }
+    m_iField = i;
+    p = AppendNumber( p, pEnd, getField(), m_kind == DURATION ? 2 : 1 );
+    if( i == iSaveField && p < pEnd )
+    {
+      *p++ = ']';
+    }
+  }
+  m_iField = iSaveField;
+  *p = '\0';
+}
+
+#endif
@@ -24,6 +24,7 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 
 #include <Arduino.h>
 #include "MenuAction.h"
+#include "MenuVirtualList.h"
 
 
 typedef MENU_ACTION_RESULT (*MENU_ACTION_CALLBACK_FUNC)( const char * pMenuText, void * pUserData );
@@ -31,17 +32,16 @@ typedef MENU_ACTION_RESULT (*MENU_ACTION_CALLBACK_FUNC)( const char * pMenuText,
 
 //To use these functions, pass a function pointer as the argument to the MenuEntry constructor.
 //pUserData should point to an unsigned int that will be set to true or false.
-void MenuEntry_BoolTrueCallbackFunc( char * pMenuText, void * pUserData );
-void MenuEntry_BoolFalseCallbackFunc( char * pMenuText, void * pUserData );
+//MenuAction_Set in MenuBind.h does the same for any type without the user data.
+inline MENU_ACTION_RESULT MenuEntry_BoolTrueCallbackFunc( const char * pMenuText, void * pUserData );
+inline MENU_ACTION_RESULT MenuEntry_BoolFalseCallbackFunc( const char * pMenuText, void * pUserData );
 
 //Use this callback function for a "Back" menu item for hardware that doesn't include a back button
-//pUserData should point to a MenfsuManager object.
+//MenuManager recognises it and goes back itself, so pUserData may be NULL.  If it is not, it should
+//point to the MenuManager object.
 template <class T>
 MENU_ACTION_RESULT MenuEntry_BackCallbackFunc( const char * pMenuText, void * pUserData );
 
-template <class T>
-class MenuManager;
-
 //The MenuEntry class represents one menu item in the overall menu system, such as "Set Time" or "Back"
 //The MenuEntry classes point to each other to create a tree of menu items.  You can navigate
 // the classes using the get* calls.  MenuManager uses the get* calls to figure out what to draw to the LCD
@@ -55,10 +55,14 @@ class MenuEntry
   //add a child menu item.  They will be kept it the order they are added, from top to bottom.
   bool addChild( MenuEntry* child);
   //Add a menu item as a sibling of this one, at the end of the sibling chain.
+  //This walks the chain, so it is constant time only when called on the last sibling.
+  //MenuManager::addChild/addSibling remember the tail and are constant time per insert.
   bool addSibling( MenuEntry* sibling);
   //Sets the previous sibling, mostly used during menu creation to notify a new entry where it's
   //previous pointer needs to point.
   void setPrevSibling( MenuEntry* prevSibling);
+  //Unhooks all children, e.g. to build a submenu again.  The children themselves are not freed.
+  void clearChildren() { m_child = NULL; }
   //Can set the action call back dynamically. Overrides what was passed to the constructor.
   bool addActionCallback( MENU_ACTION_CALLBACK_FUNC pCallback);
   
@@ -77,6 +81,8 @@ class MenuEntry
   MENU_ACTION_RESULT ExecuteCallback();
 
   bool isBackEntry() { return (m_callback == MenuEntry_BackCallbackFunc<T>); }
+  //The list behind an entry made with MenuEntry_VirtualListCallbackFunc, otherwise NULL.
+  MenuVirtualList *getVirtualList() { return m_callback == MenuEntry_VirtualListCallbackFunc ? (MenuVirtualList *)m_userData : NULL; }
   
   private:
   void* m_userData;
@@ -89,6 +95,9 @@ class MenuEntry
   MenuEntry<T>* m_prevSibling;
 };
 
+template <class T, class ENTRY = MenuEntry<T> >
+class MenuManager;
+
 template <class T>
 MenuEntry<T>::MenuEntry( const char * menuText, void * userData, MENU_ACTION_CALLBACK_FUNC func):
 	m_userData(userData), m_menuText(menuText), m_parent(NULL), m_child(NULL),
@@ -128,15 +137,13 @@ template <class T>
 bool MenuEntry<T>::addSibling( MenuEntry<T>* sibling)
 {
   sibling->setParent( m_parent );
-  if( m_nextSibling != NULL )
-  {
-    m_nextSibling->addSibling(sibling);
-  }
-  else
+  MenuEntry<T> *pLast = this;
+  while( pLast->m_nextSibling != NULL )
   {
-    m_nextSibling = sibling;
-    sibling->setPrevSibling( this );
+    pLast = pLast->m_nextSibling;
   }
+  pLast->m_nextSibling = sibling;
+  sibling->setPrevSibling( pLast );
   return true;
 }
 
@@ -188,16 +195,16 @@ void MenuEntry<T>::setParent( MenuEntry<T> * parent)
   m_parent = parent;
 }
 
-template <class T>
-void MenuEntry_BoolTrueCallbackFunc( const char * pMenuText, void * pUserData )
+inline MENU_ACTION_RESULT MenuEntry_BoolTrueCallbackFunc( const char * pMenuText, void * pUserData )
 {
   *((unsigned int *)pUserData) = true;
+  return MENU_ACTION_RESULT_NONE;
 }
 
-template <class T>
-void MenuEntry_BoolFalseCallbackFunc( const char * pMenuText, void * pUserData )
+inline MENU_ACTION_RESULT MenuEntry_BoolFalseCallbackFunc( const char * pMenuText, void * pUserData )
 {
   *((unsigned int *)pUserData) = false;
+  return MENU_ACTION_RESULT_NONE;
 }
 
 //template <class T>
@@ -209,7 +216,10 @@ void MenuEntry_BoolFalseCallbackFunc( const char * pMenuText, void * pUserData )
 template <class T>
 MENU_ACTION_RESULT MenuEntry_BackCallbackFunc( const char * pMenuText, void * pUserData )
 {
-  ((MenuManager<T> *)pUserData)->DoMenuAction( MENU_ACTION_BACK );
+  if( pUserData != NULL )
+  {
+    ((MenuManager<T> *)pUserData)->DoMenuAction( MENU_ACTION_BACK );
+  }
   return MENU_ACTION_RESULT_NONE;
 }
 
@@ -0,0 +1,168 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MenuEntryPool_h
+#define MenuEntryPool_h 1
+
+#include <Arduino.h>
+#include "MenuEntry.h"
+
+//A compact alternative to MenuEntry for menus that are built at startup but are too big for
+//a pointer per link.  The entries live in a MenuEntryPool array and link to each other with
+//INDEX sized numbers (uint8_t by default, so up to 255 entries), and isProgMem is a flag bit.
+//On AVR that is 11 bytes per entry instead of 15, plus no malloc header per entry.
+//
+//The API matches MenuEntry, so menu building code only changes where the entries come from:
+//
+//  MenuEntryPool<LiquidCrystal, 60> g_pool;
+//  MenuManager<LiquidCrystal, MenuPoolEntry<LiquidCrystal> > g_menuManager( &g_menuLCD );
+//  g_menuManager.addMenuRoot( g_pool.add( "Stopwatch", NULL, NULL ) );
+//  g_menuManager.addChild( g_pool.add( "Start", NULL, WatchStartCallback ) );
+//
+//Links are resolved against the pool the entry came from, so use one pool per <T, INDEX> pair.
+template <class T, typename INDEX = uint8_t>
+class MenuPoolEntry
+{
+  public:
+  constexpr MenuPoolEntry():
+    m_userData( NULL ), m_menuText( NULL ), m_callback( NULL ),
+    m_parent( 0 ), m_child( 0 ), m_nextSibling( 0 ), m_prevSibling( 0 ), m_flags( 0 ) {}
+  MenuPoolEntry( const char * menuText, void * userData, MENU_ACTION_CALLBACK_FUNC func):
+    m_userData( userData ), m_menuText( menuText ), m_callback( func ),
+    m_parent( 0 ), m_child( 0 ), m_nextSibling( 0 ), m_prevSibling( 0 ), m_flags( 0 ) {}
+  MenuPoolEntry( const __FlashStringHelper * menuText, void * userData, MENU_ACTION_CALLBACK_FUNC func):
+    m_userData( userData ), m_menuText( (const char *)menuText ), m_callback( func ),
+    m_parent( 0 ), m_child( 0 ), m_nextSibling( 0 ), m_prevSibling( 0 ), m_flags( FLAG_PROGMEM ) {}
+
+  bool addChild( MenuPoolEntry* child);
+  bool addSibling( MenuPoolEntry* sibling);
+  void setPrevSibling( MenuPoolEntry* prevSibling) { m_prevSibling = toIndex( prevSibling ); }
+  bool addActionCallback( MENU_ACTION_CALLBACK_FUNC pCallback) { m_callback = pCallback; return true; }
+
+  const char* getMenuText() { return m_menuText; }
+  bool isProgMem() { return ( m_flags & FLAG_PROGMEM ) != 0; }
+  void setParent( MenuPoolEntry* parent ) { m_parent = toIndex( parent ); }
+
+  MenuPoolEntry *getNextSibling() { return fromIndex( m_nextSibling ); }
+  MenuPoolEntry *getPrevSibling() { return fromIndex( m_prevSibling ); }
+  MenuPoolEntry *getChild() { return fromIndex( m_child ); }
+  MenuPoolEntry *getParent() { return fromIndex( m_parent ); }
+  MENU_ACTION_RESULT ExecuteCallback();
+
+  bool isBackEntry() { return (m_callback == MenuEntry_BackCallbackFunc<T>); }
+  MenuVirtualList *getVirtualList() { return m_callback == MenuEntry_VirtualListCallbackFunc ? (MenuVirtualList *)m_userData : NULL; }
+
+  //Set by MenuEntryPool, every link is an index into this array.  Index 0 means no link.
+  static MenuPoolEntry *s_pPool;
+
+  private:
+  enum { FLAG_PROGMEM = 0x01 };
+  static INDEX toIndex( MenuPoolEntry *p ) { return p == NULL ? 0 : (INDEX)( p - s_pPool + 1 ); }
+  static MenuPoolEntry *fromIndex( INDEX i ) { return i == 0 ? NULL : s_pPool + i - 1; }
+
+  void* m_userData;
+  const char* m_menuText;
+  MENU_ACTION_CALLBACK_FUNC m_callback;
+  INDEX m_parent;
+  INDEX m_child;
+  INDEX m_nextSibling;
+  INDEX m_prevSibling;
+  uint8_t m_flags;
+};
+
+template <class T, typename INDEX>
+MenuPoolEntry<T, INDEX> *MenuPoolEntry<T, INDEX>::s_pPool = NULL;
+
+template <class T, typename INDEX>
+MENU_ACTION_RESULT MenuPoolEntry<T, INDEX>::ExecuteCallback()
+{
+  if( m_callback != NULL )
+  {
+    return m_callback(m_menuText, m_userData);
+  }
+  return MENU_ACTION_RESULT_NONE;
+}
+
+template <class T, typename INDEX>
+bool MenuPoolEntry<T, INDEX>::addChild( MenuPoolEntry<T, INDEX>* child)
+{
+  child->setParent( this );
+  if( m_child != 0 )
+  {
+    getChild()->addSibling( child );
+  }
+  else
+  {
+    m_child = toIndex( child );
+  }
+  return true;
+}
+
+template <class T, typename INDEX>
+bool MenuPoolEntry<T, INDEX>::addSibling( MenuPoolEntry<T, INDEX>* sibling)
+{
+  sibling->m_parent = m_parent;
+  MenuPoolEntry<T, INDEX> *pLast = this;
+  while( pLast->m_nextSibling != 0 )
+  {
+    pLast = pLast->getNextSibling();
+  }
+  pLast->m_nextSibling = toIndex( sibling );
+  sibling->setPrevSibling( pLast );
+  return true;
+}
+
+//Fixed storage for N MenuPoolEntry objects.  add() hands them out in order and returns NULL when full.
+template <class T, unsigned N, typename INDEX = uint8_t>
+class MenuEntryPool
+{
+  //index 0 is NULL, so the last entry's index N must still fit in INDEX
+  static_assert( N <= (INDEX)~(INDEX)0, "MenuEntryPool N too large for INDEX, use MenuEntryPool<T, N, uint16_t>" );
+
+  public:
+  constexpr MenuEntryPool(): m_entries(), m_count( 0 ) {}
+
+  MenuPoolEntry<T, INDEX> *add( const char * menuText, void * userData, MENU_ACTION_CALLBACK_FUNC func )
+  {
+    return add( MenuPoolEntry<T, INDEX>( menuText, userData, func ) );
+  }
+  MenuPoolEntry<T, INDEX> *add( const __FlashStringHelper * menuText, void * userData, MENU_ACTION_CALLBACK_FUNC func )
+  {
+    return add( MenuPoolEntry<T, INDEX>( menuText, userData, func ) );
+  }
+  unsigned getCount() { return m_count; }
+
+  private:
+  MenuPoolEntry<T, INDEX> *add( const MenuPoolEntry<T, INDEX> &entry )
+  {
+    if( m_count >= N )
+    {
+      return NULL;
+    }
+    MenuPoolEntry<T, INDEX>::s_pPool = m_entries;
+    m_entries[m_count] = entry;
+    return &m_entries[m_count++];
+  }
+
+  MenuPoolEntry<T, INDEX> m_entries[N];
+  unsigned m_count;
+};
+
+#endif
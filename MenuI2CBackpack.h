@@ -0,0 +1,423 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuI2CBackpack_h
+#define MenuI2CBackpack_h 1
+
+#include <Arduino.h>
+
+//PCF8574 backpack wiring, the common one: P0 RS, P1 RW, P2 E, P3 backlight, P4-P7 D4-D7.
+#define MENU_I2C_RS        0x01
+#define MENU_I2C_EN        0x04
+#define MENU_I2C_BACKLIGHT 0x08
+//Bytes per I2C transaction, the Wire library buffer on AVR.  Each character or command is 4 bytes.
+#ifndef MENU_I2C_CHUNK
+#define MENU_I2C_CHUNK 32
+#endif
+//Characters and commands that can wait in the queue, 2 bytes of RAM each.
+#ifndef MENU_I2C_QUEUE_SIZE
+#define MENU_I2C_QUEUE_SIZE 64
+#endif
+//clear() and home() keep the controller busy this long, in microseconds.
+#define MENU_I2C_SLOW_US 1600
+
+//An HD44780 behind a PCF8574 I2C backpack, usable as MenuLCD's T:
+//
+//  MenuI2CBackpack<TwoWire> g_lcd( &Wire, 0x27, 16, 2 );
+//  MenuLCD< MenuI2CBackpack<TwoWire> > g_menuLCD( &g_lcd, 16, 2 );
+//  ...
+//  Wire.begin();
+//  g_lcd.begin();
+//
+//Every command and character becomes four bytes on the bus, the high and low nibble each with
+//an enable pulse, and as many as fit go in one I2C transaction, so a run of characters from
+//MenuLCD costs one transaction per 8 characters instead of several per character.
+//
+//By default each call is sent before it returns.  With setAsync(true) calls only queue their
+//bytes and Poll(), called from loop(), sends one transaction each time, so drawing a frame never
+//holds up loop() for more than one transaction; a full queue is drained on the spot.
+//WIRE is anything with beginTransmission, write( buf, len ) and endTransmission, e.g. TwoWire,
+//a non-blocking TWI driver with the same calls, or MenuI2CMock below.
+template <class WIRE>
+class MenuI2CBackpack : public Print
+{
+  public:
+  MenuI2CBackpack( WIRE *pWire, uint8_t address, uint8_t cols, uint8_t rows );
+
+  //Puts the controller in 4 bit mode and clears it.  Blocks for about 60 ms.
+  void begin();
+  void clear() { Queue( 0x01, KIND_SLOW ); }
+  void home() { Queue( 0x02, KIND_SLOW ); }
+  void setCursor( uint8_t col, uint8_t row );
+  size_t write( uint8_t c ) { Queue( c, KIND_DATA ); return 1; }
+  size_t write( const uint8_t *buffer, size_t size );
+  using Print::write;
+  void scrollDisplayLeft() { Queue( 0x18, KIND_COMMAND ); }
+  void scrollDisplayRight() { Queue( 0x1C, KIND_COMMAND ); }
+  void createChar( uint8_t location, uint8_t charmap[] );
+  void setBacklight( bool fOn );
+
+  void setAsync( bool fAsync );
+  //Sends one transaction from the queue.  Returns true while there is more to send.
+  bool Poll();
+  bool isBusy() { return m_iCount > 0 || m_fWaiting; }
+  //Sends everything queued before returning.
+  void Flush();
+
+  private:
+  enum { KIND_COMMAND, KIND_DATA, KIND_SLOW };
+  void Queue( uint8_t value, uint8_t kind );
+  void Sent();
+  int Pack( uint8_t *pOut, uint8_t value, uint8_t kind );
+  void SendNibble( uint8_t nibble );
+
+  WIRE *m_pWire;
+  uint8_t m_address;
+  uint8_t m_cols;
+  uint8_t m_rows;
+  uint8_t m_backlight;
+  bool m_fAsync;
+  //queued bytes and what they are, a ring
+  uint8_t m_values[MENU_I2C_QUEUE_SIZE];
+  uint8_t m_kinds[MENU_I2C_QUEUE_SIZE];
+  uint8_t m_iHead;
+  uint8_t m_iCount;
+  //after clear() or home() nothing may be sent until MENU_I2C_SLOW_US has passed
+  bool m_fWaiting;
+  unsigned long m_ulWaitStart;
+};
+
+template <class WIRE>
+MenuI2CBackpack<WIRE>::MenuI2CBackpack( WIRE *pWire, uint8_t address, uint8_t cols, uint8_t rows ):
+  m_pWire( pWire ),
+  m_address( address ),
+  m_cols( cols ),
+  m_rows( rows ),
+  m_backlight( MENU_I2C_BACKLIGHT ),
+  m_fAsync( false ),
+  m_iHead( 0 ),
+  m_iCount( 0 ),
+  m_fWaiting( false ),
+  m_ulWaitStart( 0 )
+{
+}
+
+//Before 4 bit mode is set the controller takes single nibbles.
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::SendNibble( uint8_t nibble )
+{
+  uint8_t bytes[2] = { (uint8_t)( ( nibble << 4 ) | m_backlight | MENU_I2C_EN ), (uint8_t)( ( nibble << 4 ) | m_backlight ) };
+  m_pWire->beginTransmission( m_address );
+  m_pWire->write( bytes, 2 );
+  m_pWire->endTransmission();
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::begin()
+{
+  //the power on sequence from the HD44780 datasheet, figure 24
+  delay( 50 );
+  SendNibble( 0x3 );
+  delayMicroseconds( 4500 );
+  SendNibble( 0x3 );
+  delayMicroseconds( 4500 );
+  SendNibble( 0x3 );
+  delayMicroseconds( 150 );
+  SendNibble( 0x2 );
+  Queue( m_rows > 1 ? 0x28 : 0x20, KIND_COMMAND );  //4 bit, lines, 5x8 font
+  Queue( 0x0C, KIND_COMMAND );                      //display on, no cursor
+  Queue( 0x06, KIND_COMMAND );                      //left to right, no shift
+  Queue( 0x01, KIND_SLOW );
+  Flush();
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::setCursor( uint8_t col, uint8_t row )
+{
+  //rows 2 and 3 continue rows 0 and 1 in display memory
+  uint8_t offset = ( row & 1 ) ? 0x40 : 0x00;
+  if( row >= 2 )
+  {
+    offset += m_cols;
+  }
+  Queue( 0x80 | ( offset + col ), KIND_COMMAND );
+}
+
+template <class WIRE>
+size_t MenuI2CBackpack<WIRE>::write( const uint8_t *buffer, size_t size )
+{
+  bool fAsync = m_fAsync;
+  //queue the whole run before sending, so it goes out in as few transactions as possible
+  m_fAsync = true;
+  for( size_t i = 0; i < size; ++i )
+  {
+    Queue( buffer[i], KIND_DATA );
+  }
+  m_fAsync = fAsync;
+  if( !m_fAsync )
+  {
+    Flush();
+  }
+  return size;
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::createChar( uint8_t location, uint8_t charmap[] )
+{
+  bool fAsync = m_fAsync;
+  m_fAsync = true;
+  Queue( 0x40 | ( ( location & 7 ) << 3 ), KIND_COMMAND );
+  for( int i = 0; i < 8; ++i )
+  {
+    Queue( charmap[i], KIND_DATA );
+  }
+  m_fAsync = fAsync;
+  if( !m_fAsync )
+  {
+    Flush();
+  }
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::setBacklight( bool fOn )
+{
+  m_backlight = fOn ? MENU_I2C_BACKLIGHT : 0;
+  //the backlight only changes with the next byte on the bus, send a harmless one
+  Flush();
+  uint8_t b = m_backlight;
+  m_pWire->beginTransmission( m_address );
+  m_pWire->write( &b, 1 );
+  m_pWire->endTransmission();
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::setAsync( bool fAsync )
+{
+  m_fAsync = fAsync;
+  if( !fAsync )
+  {
+    Flush();
+  }
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::Queue( uint8_t value, uint8_t kind )
+{
+  while( m_iCount == MENU_I2C_QUEUE_SIZE )
+  {
+    Poll();
+  }
+  uint8_t i = ( m_iHead + m_iCount ) % MENU_I2C_QUEUE_SIZE;
+  m_values[i] = value;
+  m_kinds[i] = kind;
+  ++m_iCount;
+  if( !m_fAsync )
+  {
+    Flush();
+  }
+}
+
+//Four bus bytes for one command or character: each nibble set up with E high, then latched by E going low.
+template <class WIRE>
+int MenuI2CBackpack<WIRE>::Pack( uint8_t *pOut, uint8_t value, uint8_t kind )
+{
+  uint8_t flags = m_backlight | ( kind == KIND_DATA ? MENU_I2C_RS : 0 );
+  uint8_t hi = ( value & 0xF0 ) | flags;
+  uint8_t lo = (uint8_t)( value << 4 ) | flags;
+  pOut[0] = hi | MENU_I2C_EN;
+  pOut[1] = hi;
+  pOut[2] = lo | MENU_I2C_EN;
+  pOut[3] = lo;
+  return 4;
+}
+
+template <class WIRE>
+bool MenuI2CBackpack<WIRE>::Poll()
+{
+  if( m_fWaiting )
+  {
+    if( micros() - m_ulWaitStart < MENU_I2C_SLOW_US )
+    {
+      return true;
+    }
+    m_fWaiting = false;
+  }
+  if( m_iCount == 0 )
+  {
+    return false;
+  }
+  uint8_t buff[MENU_I2C_CHUNK];
+  int n = 0;
+  //a slow command ends the transaction, the next one has to wait for it
+  while( m_iCount > 0 && n + 4 <= MENU_I2C_CHUNK && !m_fWaiting )
+  {
+    uint8_t kind = m_kinds[m_iHead];
+    n += Pack( buff + n, m_values[m_iHead], kind );
+    m_iHead = ( m_iHead + 1 ) % MENU_I2C_QUEUE_SIZE;
+    --m_iCount;
+    m_fWaiting = ( kind == KIND_SLOW );
+  }
+  m_pWire->beginTransmission( m_address );
+  m_pWire->write( buff, n );
+  m_pWire->endTransmission();
+  if( m_fWaiting )
+  {
+    m_ulWaitStart = micros();
+  }
+  return isBusy();
+}
+
+template <class WIRE>
+void MenuI2CBackpack<WIRE>::Flush()
+{
+  while( Poll() )
+  {
+  }
+}
+
+//A stand-in for Wire that decodes what a MenuI2CBackpack sends, for running and measuring the
+//menu without hardware: it keeps the display memory, so the screen can be printed, and counts
+//transactions and bytes.
+class MenuI2CMock
+{
+  public:
+  MenuI2CMock( uint8_t cols, uint8_t rows ): m_cols( cols ), m_rows( rows ) { reset(); }
+
+  void beginTransmission( uint8_t address ) { ++m_ulTransactions; }
+  size_t write( const uint8_t *buffer, size_t size );
+  uint8_t endTransmission() { return 0; }
+
+  //Forgets the screen and the 4-bit decoding state, for a display that is initialised again.
+  void reset();
+  //Zeroes the counts only, so a run can be measured between two points without losing sync.
+  void resetCounters() { m_ulTransactions = 0; m_ulBytes = 0; }
+  unsigned long getTransactions() { return m_ulTransactions; }
+  unsigned long getBytes() { return m_ulBytes; }
+  //Prints the visible screen, one row per line between '|'.
+  void DumpScreen( Print &out );
+
+  private:
+  void Execute( uint8_t value, bool fData );
+
+  uint8_t m_cols;
+  uint8_t m_rows;
+  uint8_t m_ddram[0x80];
+  uint8_t m_address;
+  bool m_fCgram;
+  bool m_f4Bit;
+  bool m_fHaveHigh;
+  uint8_t m_high;
+  uint8_t m_last;
+  unsigned long m_ulTransactions;
+  unsigned long m_ulBytes;
+};
+
+inline void MenuI2CMock::reset()
+{
+  memset( m_ddram, ' ', sizeof( m_ddram ) );
+  m_address = 0;
+  m_fCgram = false;
+  m_f4Bit = false;
+  m_fHaveHigh = false;
+  m_high = 0;
+  m_last = 0;
+  resetCounters();
+}
+
+inline size_t MenuI2CMock::write( const uint8_t *buffer, size_t size )
+{
+  for( size_t i = 0; i < size; ++i )
+  {
+    uint8_t b = buffer[i];
+    ++m_ulBytes;
+    //the controller latches D4-D7 when E goes from high to low
+    if( ( m_last & MENU_I2C_EN ) && !( b & MENU_I2C_EN ) )
+    {
+      uint8_t nibble = b & 0xF0;
+      bool fData = ( b & MENU_I2C_RS ) != 0;
+      if( !m_f4Bit )
+      {
+        //8 bit mode during begin(), the low nibble pins aren't wired
+        m_f4Bit = ( nibble == 0x20 );
+      }
+      else if( !m_fHaveHigh )
+      {
+        m_high = nibble;
+        m_fHaveHigh = true;
+      }
+      else
+      {
+        Execute( m_high | ( nibble >> 4 ), fData );
+        m_fHaveHigh = false;
+      }
+    }
+    m_last = b;
+  }
+  return size;
+}
+
+inline void MenuI2CMock::Execute( uint8_t value, bool fData )
+{
+  if( fData )
+  {
+    if( !m_fCgram )
+    {
+      m_ddram[m_address & 0x7F] = value;
+      ++m_address;
+    }
+    return;
+  }
+  if( value == 0x01 )
+  {
+    memset( m_ddram, ' ', sizeof( m_ddram ) );
+    m_address = 0;
+    m_fCgram = false;
+  }
+  else if( ( value & 0xFE ) == 0x02 )
+  {
+    m_address = 0;
+    m_fCgram = false;
+  }
+  else if( value & 0x80 )
+  {
+    m_address = value & 0x7F;
+    m_fCgram = false;
+  }
+  else if( value & 0x40 )
+  {
+    m_fCgram = true;
+  }
+}
+
+inline void MenuI2CMock::DumpScreen( Print &out )
+{
+  for( uint8_t row = 0; row < m_rows; ++row )
+  {
+    uint8_t offset = ( ( row & 1 ) ? 0x40 : 0x00 ) + ( row >= 2 ? m_cols : 0 );
+    out.print( '|' );
+    for( uint8_t col = 0; col < m_cols; ++col )
+    {
+      uint8_t c = m_ddram[offset + col];
+      out.print( (char)( c < 0x20 ? '#' : c ) );
+    }
+    out.println( '|' );
+  }
+}
+
+#endif
@@ -22,6 +22,8 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #ifndef MenuIntHelper_H
 
 #define MenuIntHelper_H 1
+//Deprecated: MenuManager edits numbers with MenuEditor (MenuEditor.h) and no longer uses this class.
+//It is kept so existing sketches that use it directly still build.
 class MenuIntHelper
 {
   public:
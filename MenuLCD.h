@@ -21,64 +21,205 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #ifndef MenuLCD_H
 #define MenuLCD_H 1
 
+#include <Arduino.h>
+#include "MenuStats.h"
+
+//The HD44780 has 8 CGRAM slots.  Character codes 8-15 show the same slots as 0-7, MenuLCD hands out
+//those so a glyph never ends a C string.
+#define MENU_GLYPH_SLOTS 8
+#define MENU_GLYPH_FIRST_CHAR 8
+//How many glyph ids registerGlyph accepts, 0 to MENU_MAX_GLYPHS - 1.
+#ifndef MENU_MAX_GLYPHS
+#define MENU_MAX_GLYPHS 16
+#endif
+
 template <class T>
 class MenuLCD
 {
   public:
   // Note: LCD must be created and initialized outside:
   MenuLCD(T *pLCD, int characters, int lines);
+  ~MenuLCD();
   template <typename MYSTR> bool PrintMenu( const MYSTR * pString[], int nLines, int nSelectedLine /*= 0*/);
+  //Like PrintMenu, but each row says where its text lives: pIsProgMem[i] true means pString[i] is in flash.
+  //Flash text is read straight into the frame a byte at a time, it is never copied to a RAM string first.
+  bool PrintMenu( const char * pString[], const bool pIsProgMem[], int nLines, int nSelectedLine );
+  //Redraws one row of a menu drawn by PrintMenu, leaving the other rows alone.  Used for the marquee.
+  template <typename MYSTR> bool PrintMenuRow( const MYSTR * pString, int iRow, bool fSelected );
   bool PrintLineRight( const char* pString, int iRow );
+  //Like PrintLineRight, but only the iWidth rightmost cells of the row are cleared and reused.
+  bool PrintFieldRight( const char* pString, int iRow, int iWidth );
   bool PrintLine( const char* pString, int iRow );
   int getLines();
   int getCharacters();
   void ClearLCD();
+  //Direct access to the display.  Anything written through it bypasses the shadow buffer,
+  //so call Invalidate() afterwards to have the next draw repaint the whole screen.
   T * getLCD();
+#if MENU_ENABLE_STATS
+  unsigned long getCharsWritten() { return m_ulCharsWritten; }
+  unsigned long getCursorMoves() { return m_ulCursorMoves; }
+  void resetCounters() { m_ulCharsWritten = 0; m_ulCursorMoves = 0; }
+#endif
+  //Forget what is on the glass.  The next draw clears the display and rewrites every cell.
+  void Invalidate();
+  //Prints the screen as last drawn, one row per line between '|'.
+  void DumpScreen( Print &out );
+
+  //Custom glyphs.  Register any number of 8 row bitmaps by id, then ask getGlyph for the character
+  //to put in your text.  Glyphs are moved into the 8 CGRAM slots as needed, evicting the one used
+  //longest ago, preferably one not on screen, and are uploaded by the next draw, before any text is sent.
+  //Slots handed out since the last draw are kept for it, so up to 8 different glyphs fit in one draw.
+  //A glyph already in a slot is not sent again.  pBitmap must stay valid while it is registered.
+  void registerGlyph( uint8_t id, const uint8_t *pBitmap );
+  //Returns the character for glyph id, or cFallback if it is not registered or all 8 slots are taken by the next draw.
+  char getGlyph( uint8_t id, char cFallback = '?' );
+  //Call after writing CGRAM with createChar yourself: every cached glyph is sent again by the next draw.
+  void InvalidateGlyphs();
 
   typedef enum { LEFT, RIGHT } Direction;
 
+  //Shifts the whole display one column.  The display memory is not touched, so the
+  //shadow buffer stays valid and ResetScroll() brings the same screen back.
+  void ScrollDisplay( Direction dir );
+  void ResetScroll();
+
 
   //void WipeMenu( const char* pString[], int nLines, typename MenuLCD<T>::Direction dir );
 
   
   private:
+  //It owns the two frame buffers, so copying would free them twice.  Not implemented.
+  MenuLCD( const MenuLCD & );
+  MenuLCD &operator=( const MenuLCD & );
+
+  static int CopyText( char *pDest, int nMax, const char *pString );
+  static int CopyText( char *pDest, int nMax, const __FlashStringHelper *pString );
+  bool isSlotOnScreen( int iSlot );
+  void UploadGlyphs();
+  template <typename MYSTR> void FillMenuRow( int iRow, const MYSTR *pString, int nSelectedLine );
+  void Flush();
+
   T* m_pLCD;
   int m_characters;
   int m_lines;
+  //m_pFrame is the screen we want, m_pShadow is the screen the controller is showing.
+  //Both are m_lines rows of m_characters cells; Flush() sends only the cells that differ.
+  char* m_pFrame;
+  char* m_pShadow;
+  bool m_fShadowValid;
+  //Where the controller will put the next character, -1 when we don't know.
+  int m_iCursorCol;
+  int m_iCursorRow;
+  //m_pGlyphs[id] is the registered bitmap, m_glyphSlot[id] the CGRAM slot holding it or -1.
+  const uint8_t* m_pGlyphs[MENU_MAX_GLYPHS];
+  int8_t m_glyphSlot[MENU_MAX_GLYPHS];
+  //Per slot: the glyph id in it or -1, and the clock value of its last getGlyph.
+  int8_t m_slotGlyph[MENU_GLYPH_SLOTS];
+  unsigned int m_slotUsed[MENU_GLYPH_SLOTS];
+  unsigned int m_uGlyphClock;
+  //Slots whose bitmap the controller doesn't have yet, and slots handed out since the last Flush(), one bit each.
+  uint8_t m_uploadMask;
+  uint8_t m_pendingMask;
+#if MENU_ENABLE_STATS
+  unsigned long m_ulCharsWritten;
+  unsigned long m_ulCursorMoves;
+#endif
 };
 
 template <class T>
 MenuLCD<T>::MenuLCD(T *pLCD, int characters, int lines)
 : m_pLCD(pLCD),
   m_characters( characters ),
-  m_lines( lines )
+  m_lines( lines ),
+  m_pFrame( new char[ characters * lines ] ),
+  m_pShadow( new char[ characters * lines ] ),
+  m_fShadowValid( false ),
+  m_iCursorCol( -1 ),
+  m_iCursorRow( -1 ),
+  m_uGlyphClock( 0 ),
+  m_uploadMask( 0 ),
+  m_pendingMask( 0 )
+{
+  memset( m_pGlyphs, 0, sizeof( m_pGlyphs ) );
+  memset( m_glyphSlot, -1, sizeof( m_glyphSlot ) );
+  memset( m_slotGlyph, -1, sizeof( m_slotGlyph ) );
+  memset( m_slotUsed, 0, sizeof( m_slotUsed ) );
+#if MENU_ENABLE_STATS
+  resetCounters();
+#endif
+  memset( m_pFrame, ' ', m_characters * m_lines );
+}
+
+template <class T>
+MenuLCD<T>::~MenuLCD()
 {
+  delete [] m_pFrame;
+  delete [] m_pShadow;
 }
 
 template <class T>
 template <typename MYSTR>
 bool MenuLCD<T>::PrintMenu( const MYSTR* pString[], int nLines, int nSelectedLine /*= 0*/)
 {
-  m_pLCD->clear();
-  for( int i =0; i < nLines; i++ )
+  memset( m_pFrame, ' ', m_characters * m_lines );
+  for( int i =0; i < nLines && i < m_lines; i++ )
   {
-    m_pLCD->setCursor(0, i);
-	if (nSelectedLine >= 0) {
-      if(i == nSelectedLine)
-      {
-         m_pLCD->write( '>');
-      }
-      else
-      {
-        m_pLCD->write(' ');
-      }
-      m_pLCD->setCursor(1,i);
-	}
-    m_pLCD->print( pString[i] );
+    FillMenuRow( i, pString[i], nSelectedLine );
+  }
+  Flush();
+  return true;
+}
+
+template <class T>
+bool MenuLCD<T>::PrintMenu( const char* pString[], const bool pIsProgMem[], int nLines, int nSelectedLine )
+{
+  memset( m_pFrame, ' ', m_characters * m_lines );
+  for( int i =0; i < nLines && i < m_lines; i++ )
+  {
+    if( pIsProgMem[i] )
+    {
+      FillMenuRow( i, (const __FlashStringHelper *)pString[i], nSelectedLine );
+    }
+    else
+    {
+      FillMenuRow( i, pString[i], nSelectedLine );
+    }
+  }
+  Flush();
+  return true;
+}
+
+template <class T>
+template <typename MYSTR>
+bool MenuLCD<T>::PrintMenuRow( const MYSTR* pString, int iRow, bool fSelected )
+{
+  if( iRow < 0 || iRow >= m_lines )
+  {
+    return false;
   }
+  memset( m_pFrame + iRow * m_characters, ' ', m_characters );
+  FillMenuRow( iRow, pString, fSelected ? iRow : m_lines );
+  Flush();
   return true;
 }
 
+template <class T>
+template <typename MYSTR>
+void MenuLCD<T>::FillMenuRow( int iRow, const MYSTR *pString, int nSelectedLine )
+{
+  char *pRow = m_pFrame + iRow * m_characters;
+  if (nSelectedLine >= 0)
+  {
+    pRow[0] = ( iRow == nSelectedLine ) ? '>' : ' ';
+    CopyText( pRow + 1, m_characters - 1, pString );
+  }
+  else
+  {
+    CopyText( pRow, m_characters, pString );
+  }
+}
+
 /*template <class T>
 void MenuLCD<T>::WipeMenu( const char* pString[], int nLines, typename MenuLCD<T>::Direction dir )
 {
@@ -121,26 +262,43 @@ void MenuLCD<T>::WipeMenu( const char* pString[], int nLines, typename MenuLCD<T
 template <class T>
 bool MenuLCD<T>::PrintLineRight( const char* pString, int iRow )
 {
-  //clear the line
-  char buff[ m_characters ];
-  for( int i = 0; i < m_characters; ++i )
+  return PrintFieldRight( pString, iRow, m_characters );
+}
+
+template <class T>
+bool MenuLCD<T>::PrintFieldRight( const char* pString, int iRow, int iWidth )
+{
+  if( iRow < 0 || iRow >= m_lines )
+  {
+    return false;
+  }
+  if( iWidth > m_characters )
   {
-    buff[i] = ' ';
+    iWidth = m_characters;
   }
-  m_pLCD->setCursor( 0, iRow );
-  m_pLCD->print( buff );
-  //now print the new number
-  m_pLCD->setCursor(m_characters - strlen(pString),iRow);
-  m_pLCD->print( pString );
+  //clear the field, then right align the new text.  If it is too long keep the rightmost part.
+  memset( m_pFrame + ( iRow + 1 ) * m_characters - iWidth, ' ', iWidth );
+  int iLen = strlen( pString );
+  if( iLen > iWidth )
+  {
+    pString += iLen - iWidth;
+    iLen = iWidth;
+  }
+  CopyText( m_pFrame + ( iRow + 1 ) * m_characters - iLen, iLen, pString );
+  Flush();
   return true;
 }
 
 template <class T>
 bool MenuLCD<T>::PrintLine( const char* pString, int iRow )
 {
-  //clear the line
-  m_pLCD->setCursor( 0, iRow );
-  m_pLCD->print( pString );
+  if( iRow < 0 || iRow >= m_lines )
+  {
+    return false;
+  }
+  //overwrites the start of the line, the rest of the row is left alone
+  CopyText( m_pFrame + iRow * m_characters, m_characters, pString );
+  Flush();
   return true;
 }
 
@@ -159,7 +317,8 @@ int MenuLCD<T>::getCharacters()
 template <class T>
 void MenuLCD<T>::ClearLCD()
 {
-  m_pLCD->clear();
+  memset( m_pFrame, ' ', m_characters * m_lines );
+  Flush();
 }
 
 template <class T>
@@ -168,4 +327,248 @@ T * MenuLCD<T>::getLCD()
   return m_pLCD;
 }
 
+template <class T>
+void MenuLCD<T>::ScrollDisplay( typename MenuLCD<T>::Direction dir )
+{
+  if( dir == LEFT )
+  {
+    m_pLCD->scrollDisplayLeft();
+  }
+  else
+  {
+    m_pLCD->scrollDisplayRight();
+  }
+}
+
+template <class T>
+void MenuLCD<T>::ResetScroll()
+{
+  m_pLCD->home();
+  m_iCursorCol = 0;
+  m_iCursorRow = 0;
+}
+
+template <class T>
+void MenuLCD<T>::Invalidate()
+{
+  m_fShadowValid = false;
+  m_iCursorRow = -1;
+}
+
+//Copies at most nMax characters of pString into the frame, without a terminator.
+//Returns the number of cells written.
+template <class T>
+int MenuLCD<T>::CopyText( char *pDest, int nMax, const char *pString )
+{
+  int i = 0;
+  for( ; i < nMax && pString[i] != '\0'; ++i )
+  {
+    pDest[i] = pString[i];
+  }
+  return i;
+}
+
+template <class T>
+int MenuLCD<T>::CopyText( char *pDest, int nMax, const __FlashStringHelper *pString )
+{
+  const char *p = (const char *)pString;
+  int i = 0;
+  for( ; i < nMax; ++i )
+  {
+    char c = pgm_read_byte( p + i );
+    if( c == '\0' )
+    {
+      break;
+    }
+    pDest[i] = c;
+  }
+  return i;
+}
+
+template <class T>
+void MenuLCD<T>::registerGlyph( uint8_t id, const uint8_t *pBitmap )
+{
+  if( id >= MENU_MAX_GLYPHS )
+  {
+    return;
+  }
+  m_pGlyphs[id] = pBitmap;
+  int iSlot = m_glyphSlot[id];
+  if( iSlot >= 0 )
+  {
+    if( pBitmap != NULL )
+    {
+      //new picture for a glyph that is already loaded
+      m_uploadMask |= 1 << iSlot;
+    }
+    else
+    {
+      m_slotGlyph[iSlot] = -1;
+      m_glyphSlot[id] = -1;
+      m_uploadMask &= ~( 1 << iSlot );
+    }
+  }
+}
+
+template <class T>
+char MenuLCD<T>::getGlyph( uint8_t id, char cFallback )
+{
+  if( id >= MENU_MAX_GLYPHS || m_pGlyphs[id] == NULL )
+  {
+    return cFallback;
+  }
+  int iSlot = m_glyphSlot[id];
+  if( iSlot < 0 )
+  {
+    //a free slot, else the least recently used one the next draw doesn't need, one nobody can see first
+    bool fSeen = true;
+    for( int i = 0; i < MENU_GLYPH_SLOTS; ++i )
+    {
+      if( m_slotGlyph[i] < 0 )
+      {
+        iSlot = i;
+        break;
+      }
+      if( m_pendingMask & ( 1 << i ) )
+      {
+        continue;
+      }
+      bool fOnScreen = isSlotOnScreen( i );
+      if( iSlot < 0 || ( fSeen && !fOnScreen ) ||
+          ( fSeen == fOnScreen && m_uGlyphClock - m_slotUsed[i] > m_uGlyphClock - m_slotUsed[iSlot] ) )
+      {
+        iSlot = i;
+        fSeen = fOnScreen;
+      }
+    }
+    if( iSlot < 0 )
+    {
+      return cFallback;
+    }
+    if( m_slotGlyph[iSlot] >= 0 )
+    {
+      m_glyphSlot[m_slotGlyph[iSlot]] = -1;
+    }
+    m_slotGlyph[iSlot] = id;
+    m_glyphSlot[id] = iSlot;
+    m_uploadMask |= 1 << iSlot;
+  }
+  m_slotUsed[iSlot] = ++m_uGlyphClock;
+  m_pendingMask |= 1 << iSlot;
+  return (char)( MENU_GLYPH_FIRST_CHAR + iSlot );
+}
+
+template <class T>
+void MenuLCD<T>::InvalidateGlyphs()
+{
+  for( int i = 0; i < MENU_GLYPH_SLOTS; ++i )
+  {
+    if( m_slotGlyph[i] >= 0 )
+    {
+      m_uploadMask |= 1 << i;
+    }
+  }
+}
+
+//The frame still holds the last draw when getGlyph runs, so this is what is showing now.
+template <class T>
+bool MenuLCD<T>::isSlotOnScreen( int iSlot )
+{
+  return memchr( m_pFrame, MENU_GLYPH_FIRST_CHAR + iSlot, m_characters * m_lines ) != NULL;
+}
+
+//Sends the glyphs that changed slot since the last draw, all before any text.
+template <class T>
+void MenuLCD<T>::UploadGlyphs()
+{
+  for( int i = 0; i < MENU_GLYPH_SLOTS; ++i )
+  {
+    if( m_uploadMask & ( 1 << i ) )
+    {
+      m_pLCD->createChar( i, (uint8_t *)m_pGlyphs[m_slotGlyph[i]] );
+    }
+  }
+  m_uploadMask = 0;
+  //createChar leaves the address counter in CGRAM
+  m_iCursorRow = -1;
+}
+
+//Sends the cells that differ between the frame and the shadow to the display.
+//Changed cells are sent as runs, one write() burst each.  A single unchanged cell between two
+//changes is resent rather than paying for a setCursor, and setCursor is skipped when the
+//controller's address counter is already where the run starts.
+template <class T>
+void MenuLCD<T>::Flush()
+{
+  if( m_uploadMask != 0 )
+  {
+    UploadGlyphs();
+  }
+  //this draw puts the glyphs handed out for it on screen, from now on they may be evicted
+  m_pendingMask = 0;
+  if( !m_fShadowValid )
+  {
+    m_pLCD->clear();
+    memset( m_pShadow, ' ', m_characters * m_lines );
+    m_fShadowValid = true;
+    m_iCursorCol = 0;
+    m_iCursorRow = 0;
+  }
+  for( int iRow = 0; iRow < m_lines; ++iRow )
+  {
+    char *pFrame = m_pFrame + iRow * m_characters;
+    char *pShadow = m_pShadow + iRow * m_characters;
+    int iCol = 0;
+    while( iCol < m_characters )
+    {
+      if( pFrame[iCol] == pShadow[iCol] )
+      {
+        ++iCol;
+        continue;
+      }
+      int iEnd = iCol + 1;
+      while( iEnd < m_characters )
+      {
+        if( pFrame[iEnd] != pShadow[iEnd] )
+        {
+          ++iEnd;
+        }
+        else if( iEnd + 1 < m_characters && pFrame[iEnd + 1] != pShadow[iEnd + 1] )
+        {
+          iEnd += 2;
+        }
+        else
+        {
+          break;
+        }
+      }
+      if( m_iCursorRow != iRow || m_iCursorCol != iCol )
+      {
+        m_pLCD->setCursor( iCol, iRow );
+        MENU_STATS_COUNT( m_ulCursorMoves );
+      }
+      m_pLCD->write( (const uint8_t *)( pFrame + iCol ), iEnd - iCol );
+#if MENU_ENABLE_STATS
+      m_ulCharsWritten += iEnd - iCol;
+#endif
+      memcpy( pShadow + iCol, pFrame + iCol, iEnd - iCol );
+      m_iCursorRow = iRow;
+      m_iCursorCol = iEnd;
+      iCol = iEnd;
+    }
+  }
+}
+
+//Every draw ends in Flush(), so the frame is what the display shows.
+template <class T>
+void MenuLCD<T>::DumpScreen( Print &out )
+{
+  for( int iRow = 0; iRow < m_lines; ++iRow )
+  {
+    out.print( '|' );
+    out.write( (const uint8_t *)( m_pFrame + iRow * m_characters ), m_characters );
+    out.println( '|' );
+  }
+}
+
 #endif
@@ -24,307 +24,1491 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #include "MenuEntry.h"
 #include "MenuLCD.h"
 #include "MenuAction.h"
-#include "MenuIntHelper.h"
+#include "MenuEditor.h"
+#include "MenuStats.h"
+#include "MenuSettings.h"
+#include "MenuTrace.h"
+//Most menu rows DrawMenu will use, even on taller displays.
+#ifndef MENU_MAX_LINES
+#define MENU_MAX_LINES 4
+#endif
+//How many steps MENU_ACTION_PAGE_UP/DOWN move the number during int input.
+#define MENU_INT_PAGE_STEPS 10
+//Marquee steps the selected row rests at each end before scrolling on.
+#ifndef MENU_MARQUEE_PAUSE
+#define MENU_MARQUEE_PAUSE 3
+#endif
 
-#define INT_BUF_SIZE 10
-
-template <class T>
+//MenuManager drives the navigation and drawing for one menu tree.
+//ENTRY is the node type it walks, MenuEntry<T> by default.  Any type with the same get* calls,
+//getMenuText/isProgMem, isBackEntry, getVirtualList and ExecuteCallback works, e.g. the flash resident
+//const MenuTableEntry<T> from MenuTable.h.  addChild/addSibling need a mutable ENTRY.
+//
+//Navigating never changes the tree, all position, viewport and input state lives in the manager.
+//So several displays can show one tree independently: build it through one manager and hand
+//the same root to the others with addMenuRoot.  Each extra manager costs only its own size.
+template <class T, class ENTRY>
 class MenuManager
 {
   public:
   MenuManager(MenuLCD<T>* pMenuLCD);
   MenuManager(MenuLCD<T>* pMenuLCD, bool rootAction);
 
-  bool addMenuRoot( MenuEntry<T> * p_menuEntry);
-  MenuEntry<T> * getMenuRoot();
+  bool addMenuRoot( ENTRY * p_menuEntry);
+  ENTRY * getMenuRoot();
   void DrawMenu();
-  void DoMenuAction( MENU_ACTION action );
+  //Navigation only changes state, the display is brought up to date by Render().
+  //Unless deferred rendering is on, DoMenuAction calls Render() once before returning.
+  //iCount repeats the action, e.g. a burst of encoder steps, and still draws only once.
+  void DoMenuAction( MENU_ACTION action, int iCount = 1 );
+  //Handles at most iBudget actions from a MenuActionQueue (see MenuActionQueue.h) and renders
+  //once for all of them.  Runs of the same action are merged into one DoMenuAction( action, n ).
+  //Returns how many queued actions were used up; the rest wait for the next call.
+  template <class QUEUE> int DoQueuedMenuActions( QUEUE &queue, int iBudget );
+  //Draws the menu (or the int input row) if anything changed since the last draw.
+  //Call it once per loop() when deferred rendering is on.
+  void Render();
+  void setDeferredRender( bool fDefer );
   void MenuUp();
   void MenuDown();
   void MenuSelect();
   void MenuBack();
-  void addChild( MenuEntry<T> * p_menuEntry );
-  void addSibling( MenuEntry<T> * p_menuEntry );
+  //Fast moves through long lists.  A page is one screen (getLines()).
+  //With a buffer from setNavIndex they are O(1), otherwise they walk the sibling chain.
+  void MenuPageUp();
+  void MenuPageDown();
+  void MenuFirst();
+  void MenuLast();
+  //Selects the iIndex'th entry (0 based) of the current list.  O(1) with the index.
+  //Like DoMenuAction( MENU_ACTION_JUMP, iIndex + 1 ): traced, ignored during int input, and drawn.
+  void MenuJumpTo( int iIndex );
+  //Selects the next entry after the current one whose text starts with c, ignoring case,
+  //wrapping around to the top.  Returns false if there is none.
+  //This is always a linear scan of the list; the index only saves walking the sibling links.
+  //Like DoMenuAction( MENU_ACTION_SEEK, c ).
+  bool MenuSeek( char c );
+  //Room for the lazily built index of the list being browsed: ppBuffer must hold iSize entries.
+  //It is rebuilt on the first fast move in a new list; lists longer than iSize are walked instead.
+  void setNavIndex( ENTRY **ppBuffer, int iSize );
+  void addChild( ENTRY * p_menuEntry );
+  void addSibling( ENTRY * p_menuEntry );
+  //Unhooks the children of pParent so the submenu can be built again.  If the menu is showing
+  //something inside it, it goes back to pParent.  The entries are not freed, see MenuArena.h.
+  //Only this manager is moved out of the submenu: with a shared tree, the other managers
+  //must not be inside it, or must be sent back with SelectRoot() before they draw again.
+  void ClearChildren( ENTRY * pParent );
   void SelectRoot();
   template <typename MYSTR> void DoIntInput( int iMin, int iMax, int iStart, int iSteps, const MYSTR **label, int iLabelLines, int *pInt );
+  //More editors, see MenuEditor.h.  They start from the variable's current value, write every
+  //change straight back to it, and end on SELECT after the last field.
+  //A number of any integer type V, shown with iDecimals digits after the point (1234 as 12.34 for 2).
+  template <typename MYSTR, class V> void DoNumberInput( long lMin, long lMax, long lStep, uint8_t iDecimals, const MYSTR **label, int iLabelLines, V *pValue );
+  //An index into ppChoices, shown as the choice's text.
+  template <typename MYSTR, class V> void DoChoiceInput( const char * const *ppChoices, int iCount, const MYSTR **label, int iLabelLines, V *pValue );
+  //A number of seconds shown and edited as HH:MM:SS, one field at a time.  BACK goes to the previous field.
+  template <typename MYSTR, class V> void DoDurationInput( const MYSTR **label, int iLabelLines, V *pSeconds );
+  //iCount bytes, such as an IP address, edited one at a time.
+  template <typename MYSTR> void DoOctetInput( const MYSTR **label, int iLabelLines, uint8_t *pOctets, int iCount );
   void DrawInputRow( char *pString );
 
+  //Starts the wipe transition.  It is advanced by Update(), and the menu is not
+  //redrawn until it finishes or is cancelled by the next DoMenuAction.
+  //Selecting a leaf wipes first and runs the callback after, so what it draws stays on screen.
   void WipeMenu(typename MenuLCD<T>::Direction dir);
+  void CancelWipe();
+  bool isWiping();
+  void setWipeEnabled( bool fEnabled );
+  //Without deferred rendering the wipe is played by Update(), and skipped if loop() doesn't call it.
+  //With fBlocking, DoMenuAction plays it to the end before returning, waiting with delay() as it used to.
+  void setBlockingWipe( bool fBlocking );
+  void setWipeStepMillis( unsigned int iStepMillis );
+  //Selected entries too long for the display scroll sideways, one character every iStepMillis.
+  //Only Update() moves the marquee, so it needs loop() to call Update().
+  void setMarqueeEnabled( bool fEnabled );
+  void setMarqueeStepMillis( unsigned int iStepMillis );
+  //Values edited through this menu are saved by pSettings: straight after an edit ends or an entry
+  //callback runs, and otherwise once they have been left alone (see MenuSettings.h).  The saving is
+  //done by Update(), one byte per call, so DoMenuAction never waits for the EEPROM.  Without deferred
+  //rendering, if loop() never calls Update(), DoMenuAction writes a due save whole before it returns.
+  void setSettings( MenuSettings *pSettings );
+  //Records every action handled from now on, with its time, into pTrace (see MenuTrace.h).  NULL stops it.
+  void setTrace( MenuTrace *pTrace );
+  //Call from loop() with millis() when deferred rendering is on.  Steps the wipe and the marquee, and renders.
+  void Update( unsigned long ulNowMillis );
+
+  //The manager whose entry callback is running, NULL outside callbacks.  When several managers
+  //share one tree (one per display), a callback uses this to reach the display that selected it,
+  //e.g. MenuManager<LiquidCrystal>::getActiveManager()->DoIntInput( ... ).
+  static MenuManager *getActiveManager();
+
+#if MENU_ENABLE_STATS
+  //Timing of actions, draws, wipes and callbacks, plus MenuLCD's write counters.  See MenuStats.h.
+  const MenuStats &getStats();
+  void resetStats();
+  void PrintStats( Print &out );
+#endif
 
   
   private:
-  MenuEntry<T>* m_pRootMenuEntry;
-  MenuEntry<T>* m_pCurrentMenuEntry;
+  void HandleAction( MENU_ACTION action, int iCount );
+  void FinishActions();
+  int getVisibleLines();
+  void SyncViewport();
+  bool isNavIndexValid();
+  bool BuildNavIndex();
+  void SetNavPosition( int iPos, int iTop );
+  void JumpTo( int iIndex );
+  bool SeekTo( char c );
+  static char getFirstChar( ENTRY *pEntry );
+  void DrawList();
+  template <typename MYSTR> void StartInput( const MYSTR **label, int iLabelLines );
+  MENU_ACTION_RESULT ExecuteEntryCallback();
+  void SelectAfterWipe();
+  void RunSelect();
+  void EndWipe( bool fDrawFirst );
+  void StepMarquee();
+  void SetListPosition( int iPos, int iTop );
+
+  ENTRY* m_pRootMenuEntry;
+  ENTRY* m_pCurrentMenuEntry;
+  //The viewport: the sibling drawn on the top row, and the row the cursor is on.
+  //A NULL m_pTopMenuEntry makes the next draw place the window around the current entry.
+  ENTRY* m_pTopMenuEntry;
+  int m_iCursorRow;
+  //The entry added last by addChild/addSibling, so the next insert does not walk the chain.
+  ENTRY* m_pBuildTail;
+  //The index of the sibling list holding m_pCurrentMenuEntry, and its position in it.
+  //m_iNavCount is 0 while there is no usable index.
+  ENTRY** m_ppNavIndex;
+  int m_iNavIndexSize;
+  int m_iNavCount;
+  int m_iNavPos;
+  //The generated list being browsed (see MenuVirtualList.h), NULL while browsing entries.
+  //m_pCurrentMenuEntry stays on the entry the list hangs off.
+  MenuVirtualList* m_pVirtualList;
+  int m_iListCount;
+  int m_iListPos;
+  int m_iListTop;
   MenuLCD<T>* m_pMenuLCD;
   unsigned int m_fDoingIntInput;
-  MenuIntHelper *m_pMenuIntHelper;
+  //The value being edited.  A member rather than a heap object, an edit never allocates.
+  MenuEditor m_editor;
   int m_iIntLine;
-  int *m_pInt; 
+  //The number as it is on the input row now, so a step only rewrites the field it occupies.
+  char m_szInputText[MENU_EDIT_BUF_SIZE];
   bool m_execRootMenuAction;
+  bool m_fRenderPending;
+  bool m_fDeferRender;
+  bool m_fWipeEnabled;
+  int m_iWipeSteps;
+  unsigned int m_iWipeStepMillis;
+  unsigned long m_ulWipeLast;
+  typename MenuLCD<T>::Direction m_wipeDir;
+  //A selected leaf or list row whose callback waits for the wipe to end, see RunSelect().
+  bool m_fSelectPending;
+  //Without deferred rendering: play the wipe inside DoMenuAction, and whether loop() calls Update().
+  bool m_fBlockingWipe;
+  bool m_fUpdateCalled;
+  //How far the selected row has scrolled.  It counts up from -MENU_MARQUEE_PAUSE, the text
+  //stays at either end while the count is outside the range it can scroll.
+  bool m_fMarqueeEnabled;
+  //The menu is what the display shows: false after a callback keeps its own screen or starts an editor.
+  bool m_fMenuShown;
+  int m_iMarqueeOffset;
+  unsigned int m_iMarqueeStepMillis;
+  unsigned long m_ulMarqueeLast;
+  MenuSettings* m_pSettings;
+  MenuTrace* m_pTrace;
+  static MenuManager *s_pActive;
+#if MENU_ENABLE_STATS
+  MenuStats m_stats;
+  unsigned long m_ulWipeStart;
+#endif
 
 };
 
-template <class T>
-MenuManager<T>::MenuManager(MenuLCD<T>* pMenuLCD): m_pMenuLCD( pMenuLCD),  m_fDoingIntInput( false ){}
+template <class T, class ENTRY>
+MenuManager<T, ENTRY>::MenuManager(MenuLCD<T>* pMenuLCD):
+ m_pRootMenuEntry( NULL ),
+ m_pCurrentMenuEntry( NULL ),
+ m_pTopMenuEntry( NULL ),
+ m_iCursorRow( 0 ),
+ m_pBuildTail( NULL ),
+ m_ppNavIndex( NULL ),
+ m_iNavIndexSize( 0 ),
+ m_iNavCount( 0 ),
+ m_iNavPos( 0 ),
+ m_pVirtualList( NULL ),
+ m_iListCount( 0 ),
+ m_iListPos( 0 ),
+ m_iListTop( 0 ),
+ m_pMenuLCD( pMenuLCD),
+ m_fDoingIntInput( false ),
+ m_iIntLine( 0 ),
+ m_execRootMenuAction( false ),
+ m_fRenderPending( false ),
+ m_fDeferRender( false ),
+ m_fWipeEnabled( true ),
+ m_iWipeSteps( 0 ),
+ m_iWipeStepMillis( 10 ),
+ m_ulWipeLast( 0 ),
+ m_wipeDir( MenuLCD<T>::LEFT ),
+ m_fSelectPending( false ),
+ m_fBlockingWipe( false ),
+ m_fUpdateCalled( false ),
+ m_fMarqueeEnabled( true ),
+ m_fMenuShown( false ),
+ m_iMarqueeOffset( -MENU_MARQUEE_PAUSE ),
+ m_iMarqueeStepMillis( 400 ),
+ m_ulMarqueeLast( 0 ),
+ m_pSettings( NULL ),
+ m_pTrace( NULL )
+{
+#if MENU_ENABLE_STATS
+  memset( &m_stats, 0, sizeof( m_stats ) );
+  m_ulWipeStart = 0;
+#endif
+}
 
 // new Constructor which allows us to define in class if we want actions being executed
 // on menus which have a child - or not.
-template <class T>
-MenuManager<T>::MenuManager(MenuLCD<T>* pMenuLCD, bool pexecRootAction ):
+template <class T, class ENTRY>
+MenuManager<T, ENTRY>::MenuManager(MenuLCD<T>* pMenuLCD, bool pexecRootAction ):
+ m_pRootMenuEntry( NULL ),
+ m_pCurrentMenuEntry( NULL ),
+ m_pTopMenuEntry( NULL ),
+ m_iCursorRow( 0 ),
+ m_pBuildTail( NULL ),
+ m_ppNavIndex( NULL ),
+ m_iNavIndexSize( 0 ),
+ m_iNavCount( 0 ),
+ m_iNavPos( 0 ),
+ m_pVirtualList( NULL ),
+ m_iListCount( 0 ),
+ m_iListPos( 0 ),
+ m_iListTop( 0 ),
  m_pMenuLCD( pMenuLCD),
+ m_fDoingIntInput( false ),
+ m_iIntLine( 0 ),
  m_execRootMenuAction (pexecRootAction),
- m_fDoingIntInput( false ) { }
+ m_fRenderPending( false ),
+ m_fDeferRender( false ),
+ m_fWipeEnabled( true ),
+ m_iWipeSteps( 0 ),
+ m_iWipeStepMillis( 10 ),
+ m_ulWipeLast( 0 ),
+ m_wipeDir( MenuLCD<T>::LEFT ),
+ m_fSelectPending( false ),
+ m_fBlockingWipe( false ),
+ m_fUpdateCalled( false ),
+ m_fMarqueeEnabled( true ),
+ m_fMenuShown( false ),
+ m_iMarqueeOffset( -MENU_MARQUEE_PAUSE ),
+ m_iMarqueeStepMillis( 400 ),
+ m_ulMarqueeLast( 0 ),
+ m_pSettings( NULL ),
+ m_pTrace( NULL )
+{
+#if MENU_ENABLE_STATS
+  memset( &m_stats, 0, sizeof( m_stats ) );
+  m_ulWipeStart = 0;
+#endif
+}
 
-template <class T>
-bool MenuManager<T>::addMenuRoot( MenuEntry<T> * p_menuItem)
+template <class T, class ENTRY>
+bool MenuManager<T, ENTRY>::addMenuRoot( ENTRY * p_menuItem)
 {
   m_pRootMenuEntry = p_menuItem;
   m_pCurrentMenuEntry = p_menuItem;
+  m_pTopMenuEntry = NULL;
+  m_pBuildTail = NULL;
+  m_pVirtualList = NULL;
   return true;
 }
 
-template <class T>
-void MenuManager<T>::addSibling( MenuEntry<T> * p_menuItem)
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::addSibling( ENTRY * p_menuItem)
 {
-  m_pCurrentMenuEntry->addSibling( p_menuItem );
+  //Entries that share a parent are all on one sibling chain, so if the last entry added
+  //has the same parent as the current one and nothing after it, it is the tail of our chain.
+  if( m_pBuildTail != NULL && m_pBuildTail->getNextSibling() == NULL &&
+      m_pBuildTail->getParent() == m_pCurrentMenuEntry->getParent() )
+  {
+    m_pBuildTail->addSibling( p_menuItem );
+  }
+  else
+  {
+    m_pCurrentMenuEntry->addSibling( p_menuItem );
+  }
+  m_pBuildTail = p_menuItem;
+  m_iNavCount = 0;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::ClearChildren( ENTRY * pParent )
+{
+  if( pParent == NULL )
+  {
+    return;
+  }
+  for( ENTRY *p = m_pCurrentMenuEntry != NULL ? m_pCurrentMenuEntry->getParent() : NULL; p != NULL; p = p->getParent() )
+  {
+    if( p == pParent )
+    {
+      m_pCurrentMenuEntry = pParent;
+      m_pTopMenuEntry = NULL;
+      m_pVirtualList = NULL;
+      m_fRenderPending = true;
+      break;
+    }
+  }
+  pParent->clearChildren();
+  m_pBuildTail = NULL;
+  m_iNavCount = 0;
 }
 
-template <class T>
-void MenuManager<T>::addChild( MenuEntry<T> * p_menuItem)
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::addChild( ENTRY * p_menuItem)
 {
-  m_pCurrentMenuEntry->addChild( p_menuItem );
+  if( m_pBuildTail != NULL && m_pBuildTail->getNextSibling() == NULL &&
+      m_pBuildTail->getParent() == m_pCurrentMenuEntry )
+  {
+    m_pBuildTail->addSibling( p_menuItem );
+  }
+  else
+  {
+    m_pCurrentMenuEntry->addChild( p_menuItem );
+  }
+  m_pBuildTail = p_menuItem;
+  m_iNavCount = 0;
 }
 
-template <class T>
-MenuEntry<T> * MenuManager<T>::getMenuRoot()
+template <class T, class ENTRY>
+ENTRY * MenuManager<T, ENTRY>::getMenuRoot()
 {
   return m_pRootMenuEntry;
 }
 
-template <class T>
-void MenuManager<T>::WipeMenu(typename MenuLCD<T>::Direction dir )
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::WipeMenu(typename MenuLCD<T>::Direction dir )
+{
+  if( !m_fWipeEnabled || ( !m_fDeferRender && !m_fBlockingWipe && !m_fUpdateCalled ) )
+  {
+    //nothing would ever step it
+    return;
+  }
+  m_wipeDir = dir;
+  m_iWipeSteps = m_pMenuLCD->getCharacters();
+#if MENU_ENABLE_STATS
+  m_ulWipeStart = micros();
+#endif
+  //make the first column due on the next Update()
+  m_ulWipeLast = millis() - m_iWipeStepMillis;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::CancelWipe()
+{
+  if( m_iWipeSteps == 0 )
+  {
+    return;
+  }
+  //the action that interrupted the wipe renders after it is applied
+  EndWipe( false );
+  if( m_pVirtualList == NULL && m_pCurrentMenuEntry != NULL )
+  {
+    //the window was never drawn for the entry the wipe led to, place it now so the action moves from there
+    SyncViewport();
+  }
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::EndWipe( bool fDrawFirst )
+{
+  m_iWipeSteps = 0;
+  MENU_STATS_RECORD( m_stats.wipes, m_ulWipeStart );
+  if( fDrawFirst && !m_fSelectPending )
+  {
+    //draw while the old screen is still scrolled out of view, then bring the display back
+    Render();
+  }
+  m_pMenuLCD->ResetScroll();
+  if( m_fSelectPending )
+  {
+    RunSelect();
+  }
+}
+
+template <class T, class ENTRY>
+bool MenuManager<T, ENTRY>::isWiping()
+{
+  return m_iWipeSteps > 0;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setWipeEnabled( bool fEnabled )
 {
-  if( dir == MenuLCD<T>::LEFT )
+  m_fWipeEnabled = fEnabled;
+  if( !fEnabled )
   {
-    for( int i = 0; i < m_pMenuLCD->getCharacters(); ++i )
+    CancelWipe();
+  }
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setBlockingWipe( bool fBlocking )
+{
+  m_fBlockingWipe = fBlocking;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setWipeStepMillis( unsigned int iStepMillis )
+{
+  m_iWipeStepMillis = iStepMillis;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::Update( unsigned long ulNowMillis )
+{
+  m_fUpdateCalled = true;
+  if( m_iWipeSteps > 0 && ulNowMillis - m_ulWipeLast >= m_iWipeStepMillis )
+  {
+    m_pMenuLCD->ScrollDisplay( m_wipeDir );
+    m_ulWipeLast = ulNowMillis;
+    if( m_iWipeSteps == 1 )
+    {
+      EndWipe( true );
+    }
+    else
+    {
+      --m_iWipeSteps;
+    }
+  }
+  Render();
+  if( m_fMarqueeEnabled && m_fMenuShown && m_iWipeSteps == 0 && !m_fDoingIntInput && m_pCurrentMenuEntry != NULL &&
+      ulNowMillis - m_ulMarqueeLast >= m_iMarqueeStepMillis )
+  {
+    m_ulMarqueeLast = ulNowMillis;
+    StepMarquee();
+  }
+  if( m_pSettings != NULL )
+  {
+    m_pSettings->Update( ulNowMillis );
+  }
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setSettings( MenuSettings *pSettings )
+{
+  m_pSettings = pSettings;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setTrace( MenuTrace *pTrace )
+{
+  m_pTrace = pTrace;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setMarqueeEnabled( bool fEnabled )
+{
+  if( !fEnabled && m_iMarqueeOffset > 0 )
+  {
+    //put the text back at its start
+    m_fRenderPending = true;
+  }
+  m_fMarqueeEnabled = fEnabled;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setMarqueeStepMillis( unsigned int iStepMillis )
+{
+  m_iMarqueeStepMillis = iStepMillis;
+}
+
+//Moves the selected row one character along if its text doesn't fit.  Only that row is redrawn.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::StepMarquee()
+{
+  int iWidth = m_pMenuLCD->getCharacters() - 1;
+  const char *pText;
+  bool fIsProgMem;
+  int iRow;
+  char buff[MENU_LIST_TEXT_SIZE];
+  if( m_pVirtualList != NULL )
+  {
+    if( m_iListPos >= m_iListCount )
     {
-      m_pMenuLCD->getLCD()->scrollDisplayLeft();
-      delay(10);
+      return;
     }
+    buff[0] = '\0';
+    m_pVirtualList->textAt( m_iListPos, buff, sizeof( buff ), m_pVirtualList->pUserData );
+    buff[sizeof( buff ) - 1] = '\0';
+    pText = buff;
+    fIsProgMem = false;
+    iRow = m_iListPos - m_iListTop;
+  }
+  else
+  {
+    pText = m_pCurrentMenuEntry->getMenuText();
+    fIsProgMem = m_pCurrentMenuEntry->isProgMem();
+    iRow = m_iCursorRow;
+  }
+  int iOverflow = ( fIsProgMem ? strlen_P( pText ) : strlen( pText ) ) - iWidth;
+  if( iOverflow <= 0 )
+  {
+    return;
+  }
+  int iShown = m_iMarqueeOffset < 0 ? 0 : ( m_iMarqueeOffset > iOverflow ? iOverflow : m_iMarqueeOffset );
+  if( ++m_iMarqueeOffset > iOverflow + MENU_MARQUEE_PAUSE )
+  {
+    m_iMarqueeOffset = -MENU_MARQUEE_PAUSE;
+  }
+  int iNext = m_iMarqueeOffset < 0 ? 0 : ( m_iMarqueeOffset > iOverflow ? iOverflow : m_iMarqueeOffset );
+  if( iNext == iShown )
+  {
+    //resting at one end
+    return;
+  }
+  if( fIsProgMem )
+  {
+    m_pMenuLCD->PrintMenuRow( (const __FlashStringHelper *)( pText + iNext ), iRow, true );
   }
   else
   {
-    for( int i = 0; i < m_pMenuLCD->getCharacters(); ++i )
+    m_pMenuLCD->PrintMenuRow( pText + iNext, iRow, true );
+  }
+}
+
+#if MENU_ENABLE_STATS
+template <class T, class ENTRY>
+const MenuStats &MenuManager<T, ENTRY>::getStats()
+{
+  m_stats.lcdChars = m_pMenuLCD->getCharsWritten();
+  m_stats.lcdCursorMoves = m_pMenuLCD->getCursorMoves();
+  return m_stats;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::resetStats()
+{
+  memset( &m_stats, 0, sizeof( m_stats ) );
+  m_pMenuLCD->resetCounters();
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::PrintStats( Print &out )
+{
+  getStats().Dump( out );
+}
+#endif
+
+template <class T, class ENTRY>
+int MenuManager<T, ENTRY>::getVisibleLines()
+{
+  int iLines = m_pMenuLCD->getLines();
+  return iLines < MENU_MAX_LINES ? iLines : MENU_MAX_LINES;
+}
+
+//Makes sure the current entry is inside the window.  If it is not, the window is rebuilt
+//with the current entry on top, then pulled up so the display stays full near the end of the list.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::SyncViewport()
+{
+  int iLines = getVisibleLines();
+  ENTRY *p = m_pTopMenuEntry;
+  for( int i = 0; p != NULL && i < iLines; ++i, p = p->getNextSibling() )
+  {
+    if( p == m_pCurrentMenuEntry )
+    {
+      m_iCursorRow = i;
+      return;
+    }
+  }
+  m_pTopMenuEntry = m_pCurrentMenuEntry;
+  m_iCursorRow = 0;
+  int iBelow = 0;
+  for( p = m_pCurrentMenuEntry->getNextSibling(); p != NULL && iBelow < iLines - 1; p = p->getNextSibling() )
+  {
+    ++iBelow;
+  }
+  while( m_iCursorRow + iBelow < iLines - 1 && m_pTopMenuEntry->getPrevSibling() != NULL )
+  {
+    m_pTopMenuEntry = m_pTopMenuEntry->getPrevSibling();
+    ++m_iCursorRow;
+  }
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::DrawMenu()
+{
+  MENU_STATS_START( ulStart );
+  m_fRenderPending = false;
+  m_fMenuShown = true;
+  m_iMarqueeOffset = -MENU_MARQUEE_PAUSE;
+  if( m_pVirtualList != NULL )
+  {
+    DrawList();
+    MENU_STATS_RECORD( m_stats.draws, ulStart );
+    return;
+  }
+  SyncViewport();
+  //siblings may mix RAM and flash text, so each row carries its own storage class
+  const char *pMenuTexts[MENU_MAX_LINES];
+  bool fIsProgMem[MENU_MAX_LINES];
+  int iLines = getVisibleLines();
+  int nLines = 0;
+  for( ENTRY *p = m_pTopMenuEntry; p != NULL && nLines < iLines; p = p->getNextSibling() )
+  {
+    pMenuTexts[nLines] = p->getMenuText();
+    fIsProgMem[nLines++] = p->isProgMem();
+  }
+  m_pMenuLCD->PrintMenu( pMenuTexts, fIsProgMem, nLines, m_iCursorRow );
+  MENU_STATS_RECORD( m_stats.draws, ulStart );
+}
+
+//Asks the list for the rows on screen only.  The count is read again so a list that
+//changed since the last draw (new scan results, a deleted file) is shown as it is now.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::DrawList()
+{
+  m_iListCount = m_pVirtualList->count( m_pVirtualList->pUserData );
+  SetListPosition( m_iListPos, m_iListTop );
+  char szRows[MENU_MAX_LINES][MENU_LIST_TEXT_SIZE];
+  const char *pRows[MENU_MAX_LINES];
+  int iLines = getVisibleLines();
+  int nLines = 0;
+  for( ; nLines < iLines && m_iListTop + nLines < m_iListCount; ++nLines )
+  {
+    szRows[nLines][0] = '\0';
+    m_pVirtualList->textAt( m_iListTop + nLines, szRows[nLines], MENU_LIST_TEXT_SIZE, m_pVirtualList->pUserData );
+    szRows[nLines][MENU_LIST_TEXT_SIZE - 1] = '\0';
+    pRows[nLines] = szRows[nLines];
+  }
+  m_pMenuLCD->PrintMenu( pRows, nLines, m_iListPos - m_iListTop );
+}
+
+//Moves the list cursor to iPos, clamped to the list, and scrolls the window starting at iTop
+//as little as needed to keep it on screen and full.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::SetListPosition( int iPos, int iTop )
+{
+  int iLines = getVisibleLines();
+  int iLastTop = m_iListCount > iLines ? m_iListCount - iLines : 0;
+  if( iPos > m_iListCount - 1 )
+  {
+    iPos = m_iListCount - 1;
+  }
+  if( iPos < 0 )
+  {
+    iPos = 0;
+  }
+  if( iTop > iPos )
+  {
+    iTop = iPos;
+  }
+  if( iTop < iPos - iLines + 1 )
+  {
+    iTop = iPos - iLines + 1;
+  }
+  if( iTop > iLastTop )
+  {
+    iTop = iLastTop;
+  }
+  m_iListPos = iPos;
+  m_iListTop = iTop;
+  m_fRenderPending = true;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::DoMenuAction( MENU_ACTION action, int iCount )
+{
+  MENU_STATS_START( ulStart );
+  HandleAction( action, iCount );
+  FinishActions();
+  MENU_STATS_RECORD( m_stats.actions[action], ulStart );
+}
+
+template <class T, class ENTRY>
+template <class QUEUE>
+int MenuManager<T, ENTRY>::DoQueuedMenuActions( QUEUE &queue, int iBudget )
+{
+  int iHandled = 0;
+  MENU_ACTION action;
+  while( iHandled < iBudget && queue.pop( &action ) )
+  {
+    int iCount = 1;
+    MENU_ACTION next;
+    while( iHandled + iCount < iBudget && queue.peek( &next ) && next == action )
     {
-      m_pMenuLCD->getLCD()->scrollDisplayRight();
-      delay(10);
+      queue.pop( &next );
+      ++iCount;
     }
+    MENU_STATS_START( ulStart );
+    HandleAction( action, iCount );
+    MENU_STATS_RECORD( m_stats.actions[action], ulStart );
+    iHandled += iCount;
   }
+  if( iHandled > 0 )
+  {
+    FinishActions();
+  }
+  return iHandled;
 }
 
-template <class T>
-void MenuManager<T>::DrawMenu()
+//Applies action iCount times.  Int input steps are applied in one go, JUMP and SEEK once with iCount as their argument.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::HandleAction( MENU_ACTION action, int iCount )
 {
-  if( m_pCurrentMenuEntry->getNextSibling() == NULL )
+  if( m_pTrace != NULL )
+  {
+    m_pTrace->Record( action, iCount, millis() );
+  }
+  //new input wins over a transition that is still running
+  CancelWipe();
+  while( iCount > 0 )
   {
-    if( m_pCurrentMenuEntry->getPrevSibling() != NULL )
+    int iSteps = 1;
+    if( m_fDoingIntInput == true )
     {
-      const char *pMenuTexts[2] = {m_pCurrentMenuEntry->getPrevSibling()->getMenuText(), m_pCurrentMenuEntry->getMenuText()};
-      if (!m_pCurrentMenuEntry->isProgMem()) {
-    	  m_pMenuLCD->PrintMenu( pMenuTexts, 2, 1 );
-      } else {
-    	  m_pMenuLCD->PrintMenu((const __FlashStringHelper **)pMenuTexts, 2, 1 );
+      //UP lowers the value, as the smaller numbers are above on a list
+      switch (action )
+      {
+        case MENU_ACTION_UP:
+          m_editor.Decrease( iCount );
+          iSteps = iCount;
+          break;
+
+        case MENU_ACTION_DOWN:
+          m_editor.Increase( iCount );
+          iSteps = iCount;
+          break;
+
+        case MENU_ACTION_SELECT:
+          //on to the next field, done after the last
+          m_fDoingIntInput = m_editor.NextField();
+          break;
+
+        case MENU_ACTION_BACK:
+          m_fDoingIntInput = m_editor.PrevField();
+          break;
+
+        case MENU_ACTION_PAGE_UP:
+          m_editor.Decrease( (long)iCount * MENU_INT_PAGE_STEPS );
+          iSteps = iCount;
+          break;
+
+        case MENU_ACTION_PAGE_DOWN:
+          m_editor.Increase( (long)iCount * MENU_INT_PAGE_STEPS );
+          iSteps = iCount;
+          break;
+
+        case MENU_ACTION_FIRST:
+          m_editor.First();
+          iSteps = iCount;
+          break;
+
+        case MENU_ACTION_LAST:
+          m_editor.Last();
+          iSteps = iCount;
+          break;
+        case MENU_ACTION_JUMP:
+        case MENU_ACTION_SEEK:
+          //the count is an argument, and the cursor stays on the value being edited
+          iSteps = iCount;
+          break;
+        case MENU_ACTION_NONE:
+          break;
+      }
+      m_fRenderPending = true;
+      if( m_pSettings != NULL && m_editor.isChanged() )
+      {
+        //each step restarts the idle wait, the end of the edit saves straight away
+        m_pSettings->MarkDirty( !m_fDoingIntInput );
       }
     }
     else
     {
-      const char * pText = m_pCurrentMenuEntry->getMenuText();
-      if (!m_pCurrentMenuEntry->isProgMem()) {
-    	  m_pMenuLCD->PrintMenu( &pText, 1, 0 );
-      } else {
-    	  m_pMenuLCD->PrintMenu( (const __FlashStringHelper **)&pText, 1, 0 );
+      switch (action )
+      {
+        case MENU_ACTION_UP:
+          this->MenuUp();
+          break;
+        case MENU_ACTION_DOWN:
+          this->MenuDown();
+          break;
+        case MENU_ACTION_SELECT:
+          this->MenuSelect();
+          break;
+        case MENU_ACTION_BACK:
+          this->MenuBack();
+          break;
+        case MENU_ACTION_PAGE_UP:
+          this->MenuPageUp();
+          break;
+        case MENU_ACTION_PAGE_DOWN:
+          this->MenuPageDown();
+          break;
+        case MENU_ACTION_FIRST:
+          this->MenuFirst();
+          break;
+        case MENU_ACTION_LAST:
+          this->MenuLast();
+          break;
+        case MENU_ACTION_JUMP:
+          JumpTo( iCount - 1 );
+          iSteps = iCount;
+          break;
+        case MENU_ACTION_SEEK:
+          SeekTo( (char)iCount );
+          iSteps = iCount;
+          break;
+        case MENU_ACTION_NONE:
+          break;
       }
     }
+    iCount -= iSteps;
   }
-  else
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::FinishActions()
+{
+  if( !m_fDeferRender )
   {
-    const char *pMenuTexts[2] = {m_pCurrentMenuEntry->getMenuText(), m_pCurrentMenuEntry->getNextSibling()->getMenuText()};
-    if (!m_pCurrentMenuEntry->isProgMem()) {
-    	m_pMenuLCD->PrintMenu( pMenuTexts, 2, 0 );
-    } else {
-    	m_pMenuLCD->PrintMenu( (const __FlashStringHelper **)pMenuTexts, 2, 0 );
+    //only when asked for: hold up the caller until the transition has run to the end
+    bool fUpdateCalled = m_fUpdateCalled;
+    while( m_fBlockingWipe && m_iWipeSteps > 0 )
+    {
+      delay( m_iWipeStepMillis );
+      Update( millis() );
+    }
+    m_fUpdateCalled = fUpdateCalled;
+    Render();
+    if( m_pSettings != NULL && !m_fUpdateCalled )
+    {
+      //loop() won't step the save, so write any that is due now
+      m_pSettings->Update( millis() );
+      while( m_pSettings->isWriting() )
+      {
+        m_pSettings->Update( millis() );
+      }
     }
   }
 }
 
-template <class T>
-void MenuManager<T>::DoMenuAction( MENU_ACTION action )
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::Render()
 {
-  if( m_fDoingIntInput == true )
+  if( !m_fRenderPending || m_iWipeSteps > 0 )
   {
-    int iNewNum = m_pMenuIntHelper->getInt();
-
-    char buff[INT_BUF_SIZE] = {0};
-    switch (action )
+    return;
+  }
+  if( m_fDoingIntInput )
+  {
+    char buff[MENU_EDIT_BUF_SIZE];
+    m_editor.Format( buff, sizeof( buff ) );
+    if( strcmp( buff, m_szInputText ) != 0 )
     {
-      case MENU_ACTION_UP:
-        iNewNum = m_pMenuIntHelper->numDecrease();
-        itoa( iNewNum, buff, 10 );
-        DrawInputRow( buff );
-        *m_pInt = iNewNum;
-        break;
-
-      case MENU_ACTION_DOWN:
-        iNewNum = m_pMenuIntHelper->numIncrease();
-        itoa( iNewNum, buff, 10 );
-        DrawInputRow( buff );
-        *m_pInt = iNewNum;
-        break;
-
-      case MENU_ACTION_SELECT:
-        m_fDoingIntInput = false;
-        DrawMenu();
-        break;
-
-      case MENU_ACTION_BACK:
-        m_fDoingIntInput = false;
-        DrawMenu();
-        break;
-      case MENU_ACTION_NONE:
-        break;
+      //only the cells of the old or the new number, whichever is wider, can change
+      int iWidth = strlen( buff );
+      int iOldWidth = strlen( m_szInputText );
+      m_pMenuLCD->PrintFieldRight( buff, m_pMenuLCD->getLines() - 1, iWidth > iOldWidth ? iWidth : iOldWidth );
+      strcpy( m_szInputText, buff );
     }
+    m_fRenderPending = false;
   }
   else
   {
-    m_pMenuLCD->ClearLCD();
-    delay(10);
     DrawMenu();
-    switch (action )
-    {
-      case MENU_ACTION_UP:
-        this->MenuUp();
-        break;
-      case MENU_ACTION_DOWN:
-        this->MenuDown();
-        break;
-      case MENU_ACTION_SELECT:
-    	this->MenuSelect();
-        break;
-      case MENU_ACTION_BACK:
-        this->MenuBack();
-        break;
-      case MENU_ACTION_NONE:
-    	break;
-    }
   }
 }
 
-template <class T>
-void MenuManager<T>::MenuUp()
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setDeferredRender( bool fDefer )
+{
+  m_fDeferRender = fDefer;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuUp()
 {
-  MenuEntry<T> *prev = m_pCurrentMenuEntry->getPrevSibling();
+  if( m_pVirtualList != NULL )
+  {
+    SetListPosition( m_iListPos - 1, m_iListTop );
+    return;
+  }
+  ENTRY *prev = m_pCurrentMenuEntry->getPrevSibling();
   if( prev != NULL )
   {
+    if( isNavIndexValid() )
+    {
+      --m_iNavPos;
+    }
+    if( m_pCurrentMenuEntry == m_pTopMenuEntry )
+    {
+      m_pTopMenuEntry = prev;
+    }
+    else
+    {
+      --m_iCursorRow;
+    }
     m_pCurrentMenuEntry = prev;
   }
   else
   {
     //Flash?
   }
-  DrawMenu();
+  m_fRenderPending = true;
 }
 
-template <class T>
-void MenuManager<T>::MenuDown()
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuDown()
 {
-  MenuEntry<T> *next = m_pCurrentMenuEntry->getNextSibling();
+  if( m_pVirtualList != NULL )
+  {
+    SetListPosition( m_iListPos + 1, m_iListTop );
+    return;
+  }
+  ENTRY *next = m_pCurrentMenuEntry->getNextSibling();
   if( next != NULL )
   {
+    if( isNavIndexValid() )
+    {
+      ++m_iNavPos;
+    }
+    //only scroll when the cursor would leave the bottom of the window
+    if( m_pTopMenuEntry != NULL && m_iCursorRow >= getVisibleLines() - 1 )
+    {
+      m_pTopMenuEntry = m_pTopMenuEntry->getNextSibling();
+    }
+    else
+    {
+      ++m_iCursorRow;
+    }
     m_pCurrentMenuEntry = next;
   }
   else
   {
     //Flash?
   }
-  DrawMenu();
+  m_fRenderPending = true;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::setNavIndex( ENTRY **ppBuffer, int iSize )
+{
+  m_ppNavIndex = ppBuffer;
+  m_iNavIndexSize = iSize;
+  m_iNavCount = 0;
+}
+
+template <class T, class ENTRY>
+bool MenuManager<T, ENTRY>::isNavIndexValid()
+{
+  return m_iNavCount > 0 && m_iNavPos >= 0 && m_iNavPos < m_iNavCount &&
+         m_ppNavIndex[m_iNavPos] == m_pCurrentMenuEntry;
+}
+
+//Makes sure the index describes the current list.  Returns false if there is no buffer or the list doesn't fit.
+template <class T, class ENTRY>
+bool MenuManager<T, ENTRY>::BuildNavIndex()
+{
+  if( isNavIndexValid() )
+  {
+    return true;
+  }
+  m_iNavCount = 0;
+  if( m_ppNavIndex == NULL )
+  {
+    return false;
+  }
+  ENTRY *p;
+  if( m_pCurrentMenuEntry->getParent() != NULL )
+  {
+    p = m_pCurrentMenuEntry->getParent()->getChild();
+  }
+  else
+  {
+    for( p = m_pCurrentMenuEntry; p->getPrevSibling() != NULL; p = p->getPrevSibling() ) {}
+  }
+  int n = 0;
+  for( ; p != NULL; p = p->getNextSibling() )
+  {
+    if( n == m_iNavIndexSize )
+    {
+      return false;
+    }
+    if( p == m_pCurrentMenuEntry )
+    {
+      m_iNavPos = n;
+    }
+    m_ppNavIndex[n++] = p;
+  }
+  m_iNavCount = n;
+  return true;
+}
+
+//Moves to the iPos'th entry of the index, with iTop on the top row.  iTop -1 lets DrawMenu place the window.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::SetNavPosition( int iPos, int iTop )
+{
+  m_iNavPos = iPos;
+  m_pCurrentMenuEntry = m_ppNavIndex[iPos];
+  if( iTop < 0 )
+  {
+    m_pTopMenuEntry = NULL;
+  }
+  else
+  {
+    m_pTopMenuEntry = m_ppNavIndex[iTop];
+    m_iCursorRow = iPos - iTop;
+  }
+  m_fRenderPending = true;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuPageUp()
+{
+  if( m_pVirtualList != NULL )
+  {
+    SetListPosition( m_iListPos - getVisibleLines(), m_iListTop - getVisibleLines() );
+    return;
+  }
+  int iLines = getVisibleLines();
+  SyncViewport();
+  if( !BuildNavIndex() )
+  {
+    //the same move as below, walking the links: entry and window both up a page, stopping at the top
+    int iMoves = 0;
+    for( ; iMoves < iLines && m_pCurrentMenuEntry->getPrevSibling() != NULL; ++iMoves )
+    {
+      m_pCurrentMenuEntry = m_pCurrentMenuEntry->getPrevSibling();
+    }
+    m_iCursorRow -= iMoves;
+    for( iMoves = 0; iMoves < iLines && m_pTopMenuEntry->getPrevSibling() != NULL; ++iMoves )
+    {
+      m_pTopMenuEntry = m_pTopMenuEntry->getPrevSibling();
+    }
+    m_iCursorRow += iMoves;
+    m_fRenderPending = true;
+    return;
+  }
+  int iPos = m_iNavPos - iLines;
+  int iTop = m_iNavPos - m_iCursorRow - iLines;
+  if( iPos < 0 )
+  {
+    iPos = 0;
+  }
+  if( iTop < 0 )
+  {
+    iTop = 0;
+  }
+  SetNavPosition( iPos, iTop );
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuPageDown()
+{
+  if( m_pVirtualList != NULL )
+  {
+    SetListPosition( m_iListPos + getVisibleLines(), m_iListTop + getVisibleLines() );
+    return;
+  }
+  int iLines = getVisibleLines();
+  SyncViewport();
+  if( !BuildNavIndex() )
+  {
+    //the same move as below, walking the links: the window only goes as far as keeps it full
+    int iMoves = 0;
+    for( ; iMoves < iLines && m_pCurrentMenuEntry->getNextSibling() != NULL; ++iMoves )
+    {
+      m_pCurrentMenuEntry = m_pCurrentMenuEntry->getNextSibling();
+    }
+    m_iCursorRow += iMoves;
+    ENTRY *pBottom = m_pTopMenuEntry;
+    for( int i = 1; i < iLines && pBottom->getNextSibling() != NULL; ++i )
+    {
+      pBottom = pBottom->getNextSibling();
+    }
+    for( iMoves = 0; iMoves < iLines && pBottom->getNextSibling() != NULL; ++iMoves )
+    {
+      pBottom = pBottom->getNextSibling();
+      m_pTopMenuEntry = m_pTopMenuEntry->getNextSibling();
+    }
+    m_iCursorRow -= iMoves;
+    m_fRenderPending = true;
+    return;
+  }
+  int iPos = m_iNavPos + iLines;
+  int iTop = m_iNavPos - m_iCursorRow + iLines;
+  int iLastTop = m_iNavCount > iLines ? m_iNavCount - iLines : 0;
+  if( iPos > m_iNavCount - 1 )
+  {
+    iPos = m_iNavCount - 1;
+  }
+  if( iTop > iLastTop )
+  {
+    iTop = iLastTop;
+  }
+  SetNavPosition( iPos, iTop );
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuFirst()
+{
+  if( m_pVirtualList != NULL )
+  {
+    SetListPosition( 0, 0 );
+    return;
+  }
+  if( BuildNavIndex() )
+  {
+    SetNavPosition( 0, 0 );
+    return;
+  }
+  while( m_pCurrentMenuEntry->getPrevSibling() != NULL )
+  {
+    m_pCurrentMenuEntry = m_pCurrentMenuEntry->getPrevSibling();
+  }
+  m_pTopMenuEntry = NULL;
+  m_fRenderPending = true;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuLast()
+{
+  if( m_pVirtualList != NULL )
+  {
+    SetListPosition( m_iListCount - 1, m_iListCount - 1 );
+    return;
+  }
+  if( BuildNavIndex() )
+  {
+    int iLines = getVisibleLines();
+    SetNavPosition( m_iNavCount - 1, m_iNavCount > iLines ? m_iNavCount - iLines : 0 );
+    return;
+  }
+  while( m_pCurrentMenuEntry->getNextSibling() != NULL )
+  {
+    m_pCurrentMenuEntry = m_pCurrentMenuEntry->getNextSibling();
+  }
+  m_pTopMenuEntry = NULL;
+  m_fRenderPending = true;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuJumpTo( int iIndex )
+{
+  if( iIndex >= 0 )
+  {
+    DoMenuAction( MENU_ACTION_JUMP, iIndex + 1 );
+  }
+}
+
+template <class T, class ENTRY>
+bool MenuManager<T, ENTRY>::MenuSeek( char c )
+{
+  //the search starts after the current entry, so it moved if and only if something matched
+  ENTRY *pBefore = m_pCurrentMenuEntry;
+  int iListPos = m_iListPos;
+  DoMenuAction( MENU_ACTION_SEEK, (unsigned char)c );
+  return m_pCurrentMenuEntry != pBefore || m_iListPos != iListPos;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::JumpTo( int iIndex )
+{
+  if( m_pVirtualList != NULL )
+  {
+    if( iIndex < m_iListCount )
+    {
+      SetListPosition( iIndex, iIndex );
+    }
+    return;
+  }
+  if( BuildNavIndex() )
+  {
+    if( iIndex < m_iNavCount )
+    {
+      SetNavPosition( iIndex, -1 );
+    }
+    return;
+  }
+  MenuFirst();
+  for( ; iIndex > 0 && m_pCurrentMenuEntry->getNextSibling() != NULL; --iIndex )
+  {
+    m_pCurrentMenuEntry = m_pCurrentMenuEntry->getNextSibling();
+  }
+}
+
+template <class T, class ENTRY>
+char MenuManager<T, ENTRY>::getFirstChar( ENTRY *pEntry )
+{
+  const char *pText = pEntry->getMenuText();
+  return toupper( pEntry->isProgMem() ? (char)pgm_read_byte( pText ) : pText[0] );
+}
+
+template <class T, class ENTRY>
+bool MenuManager<T, ENTRY>::SeekTo( char c )
+{
+  c = toupper( c );
+  if( m_pVirtualList != NULL )
+  {
+    char buff[MENU_LIST_TEXT_SIZE];
+    for( int i = 1; i < m_iListCount; ++i )
+    {
+      int iPos = ( m_iListPos + i ) % m_iListCount;
+      buff[0] = '\0';
+      m_pVirtualList->textAt( iPos, buff, sizeof( buff ), m_pVirtualList->pUserData );
+      if( toupper( buff[0] ) == c )
+      {
+        SetListPosition( iPos, iPos );
+        return true;
+      }
+    }
+    return false;
+  }
+  if( BuildNavIndex() )
+  {
+    for( int i = 1; i < m_iNavCount; ++i )
+    {
+      int iPos = ( m_iNavPos + i ) % m_iNavCount;
+      if( getFirstChar( m_ppNavIndex[iPos] ) == c )
+      {
+        SetNavPosition( iPos, -1 );
+        return true;
+      }
+    }
+    return false;
+  }
+  ENTRY *p = m_pCurrentMenuEntry;
+  for( ;; )
+  {
+    p = p->getNextSibling();
+    if( p == NULL )
+    {
+      for( p = m_pCurrentMenuEntry; p->getPrevSibling() != NULL; p = p->getPrevSibling() ) {}
+    }
+    if( p == m_pCurrentMenuEntry )
+    {
+      return false;
+    }
+    if( getFirstChar( p ) == c )
+    {
+      m_pCurrentMenuEntry = p;
+      m_pTopMenuEntry = NULL;
+      m_fRenderPending = true;
+      return true;
+    }
+  }
+}
 
+template <class T, class ENTRY>
+MenuManager<T, ENTRY> *MenuManager<T, ENTRY>::s_pActive = NULL;
+
+template <class T, class ENTRY>
+MenuManager<T, ENTRY> *MenuManager<T, ENTRY>::getActiveManager()
+{
+  return s_pActive;
 }
 
-template <class T>
-void MenuManager<T>::MenuSelect()
+template <class T, class ENTRY>
+MENU_ACTION_RESULT MenuManager<T, ENTRY>::ExecuteEntryCallback()
 {
+  //a callback may run another manager's action, so put back whoever was active before
+  MenuManager *pOuter = s_pActive;
+  s_pActive = this;
+  MENU_ACTION_RESULT result = m_pCurrentMenuEntry->ExecuteCallback();
+  s_pActive = pOuter;
+  return result;
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuSelect()
+{
+  if( m_pVirtualList != NULL )
+  {
+    if( m_pVirtualList->select != NULL && m_iListPos < m_iListCount )
+    {
+      SelectAfterWipe();
+    }
+    return;
+  }
   //
   // EDIT: Changed library to always do a callback even if the
   // menu has a child. This allows me to keep track of the menu we are in.
   //
-  if ( m_execRootMenuAction == true) {
-     m_pCurrentMenuEntry->ExecuteCallback();
-  }
-
-  MenuEntry<T> *child = m_pCurrentMenuEntry->getChild();
+  ENTRY *child = m_pCurrentMenuEntry->getChild();
   if( child != NULL )
   {
+    if ( m_execRootMenuAction == true) {
+       MENU_STATS_START( ulStart );
+       ExecuteEntryCallback();
+       MENU_STATS_RECORD( m_stats.callbacks, ulStart );
+    }
     WipeMenu( MenuLCD<T>::LEFT);
     m_pCurrentMenuEntry = child;
-    DrawMenu();
+    m_pTopMenuEntry = NULL;
+    m_fRenderPending = true;
+  }
+  else if( m_pCurrentMenuEntry->isBackEntry() )
+  {
+    //handled here rather than through the callback so a Back entry never
+    //re-enters DoMenuAction and causes a second draw
+    MenuBack();
+  }
+  else if( m_pCurrentMenuEntry->getVirtualList() != NULL )
+  {
+    WipeMenu( MenuLCD<T>::LEFT);
+    m_pVirtualList = m_pCurrentMenuEntry->getVirtualList();
+    m_iListCount = m_pVirtualList->count( m_pVirtualList->pUserData );
+    m_iListPos = 0;
+    m_iListTop = 0;
+    m_fRenderPending = true;
   }
   else
   {
-    if( !m_pCurrentMenuEntry->isBackEntry() )
-    {
-      WipeMenu( MenuLCD<T>::LEFT);
-    }
-    MENU_ACTION_RESULT result = m_pCurrentMenuEntry->ExecuteCallback();
-    if( !m_fDoingIntInput && result != MENU_ACTION_RESULT_RETAIN_DISPLAY)
-    {
-      DrawMenu();
-    }
+    SelectAfterWipe();
+  }
+}
+
+//The callback of a leaf or list row may draw its own screen, so it only runs once the wipe has
+//taken the menu off the display: right away without a wipe, otherwise from EndWipe(), either when
+//the wipe finishes or when the next action cuts it short.
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::SelectAfterWipe()
+{
+  WipeMenu( MenuLCD<T>::LEFT);
+  m_fSelectPending = true;
+  if( m_iWipeSteps == 0 )
+  {
+    RunSelect();
+  }
+}
+
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::RunSelect()
+{
+  m_fSelectPending = false;
+  MENU_STATS_START( ulStart );
+  MENU_ACTION_RESULT result;
+  if( m_pVirtualList != NULL )
+  {
+    MenuManager *pOuter = s_pActive;
+    s_pActive = this;
+    result = m_pVirtualList->select( m_iListPos, m_pVirtualList->pUserData );
+    s_pActive = pOuter;
+  }
+  else
+  {
+    result = ExecuteEntryCallback();
+  }
+  MENU_STATS_RECORD( m_stats.callbacks, ulStart );
+  if( !m_fDoingIntInput && result != MENU_ACTION_RESULT_RETAIN_DISPLAY)
+  {
+    m_fRenderPending = true;
+  }
+  else
+  {
+    //the screen belongs to the callback until the next action redraws the menu
+    m_fMenuShown = false;
+  }
+  if( m_pSettings != NULL && !m_fDoingIntInput )
+  {
+    //a bound callback such as MenuAction_Toggle may have changed a value, Update() checks and saves
+    m_pSettings->MarkDirty( true );
   }
 }
 
-template <class T>
-void MenuManager<T>::MenuBack()
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::MenuBack()
 {
+  if( m_pVirtualList != NULL )
+  {
+    //back to the entry the list hangs off, the entry viewport was left as it was
+    WipeMenu( MenuLCD<T>::RIGHT);
+    m_pVirtualList = NULL;
+    m_fRenderPending = true;
+    return;
+  }
   if( m_pCurrentMenuEntry->getParent() != NULL )
   {
     WipeMenu( MenuLCD<T>::RIGHT);
     m_pCurrentMenuEntry = m_pCurrentMenuEntry->getParent();
-    DrawMenu();
+    m_pTopMenuEntry = NULL;
+    m_fRenderPending = true;
   }
 }
 
-template <class T>
-void MenuManager<T>::SelectRoot()
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::SelectRoot()
 {
   m_pCurrentMenuEntry = m_pRootMenuEntry;
+  m_pTopMenuEntry = NULL;
+  m_pVirtualList = NULL;
 }
 
-template <class T>
-void MenuManager<T>::DrawInputRow( char *pString )
+template <class T, class ENTRY>
+void MenuManager<T, ENTRY>::DrawInputRow( char *pString )
 {
+  strncpy( m_szInputText, pString, MENU_EDIT_BUF_SIZE - 1 );
+  m_szInputText[MENU_EDIT_BUF_SIZE - 1] = '\0';
   m_pMenuLCD->PrintLineRight( pString, m_pMenuLCD->getLines() - 1 );
 }
 
-template <class T>
+template <class T, class ENTRY>
 template <typename MYSTR>
-void MenuManager<T>::DoIntInput( int iMin, int iMax, int iStart, int iSteps, const MYSTR **label, int iLabelLines, int *pInt )
+void MenuManager<T, ENTRY>::DoIntInput( int iMin, int iMax, int iStart, int iSteps, const MYSTR **label, int iLabelLines, int *pInt )
 {
-  char buff[INT_BUF_SIZE] = {0};
-  m_fDoingIntInput = true;
+  m_editor.SetNumber( iMin, iMax, iStart, iSteps, 0, pInt, MenuEditor_Store<int> );
+  StartInput( label, iLabelLines );
+}
 
-  m_pInt = pInt;
-  *pInt = iStart;
+template <class T, class ENTRY>
+template <typename MYSTR, class V>
+void MenuManager<T, ENTRY>::DoNumberInput( long lMin, long lMax, long lStep, uint8_t iDecimals, const MYSTR **label, int iLabelLines, V *pValue )
+{
+  m_editor.SetNumber( lMin, lMax, *pValue, lStep, iDecimals, pValue, MenuEditor_Store<V> );
+  StartInput( label, iLabelLines );
+}
 
-  //The MenuIntHelper class will keep track of the input, but all other logic will stay here
-  if( m_pMenuIntHelper != NULL )
-  {
-    delete m_pMenuIntHelper;
-  }
-  m_pMenuIntHelper = new MenuIntHelper(  iMin, iMax, iStart, iSteps );
+template <class T, class ENTRY>
+template <typename MYSTR, class V>
+void MenuManager<T, ENTRY>::DoChoiceInput( const char * const *ppChoices, int iCount, const MYSTR **label, int iLabelLines, V *pValue )
+{
+  m_editor.SetChoice( ppChoices, iCount, *pValue, pValue, MenuEditor_Store<V> );
+  StartInput( label, iLabelLines );
+}
+
+template <class T, class ENTRY>
+template <typename MYSTR, class V>
+void MenuManager<T, ENTRY>::DoDurationInput( const MYSTR **label, int iLabelLines, V *pSeconds )
+{
+  m_editor.SetDuration( *pSeconds, pSeconds, MenuEditor_Store<V> );
+  StartInput( label, iLabelLines );
+}
+
+template <class T, class ENTRY>
+template <typename MYSTR>
+void MenuManager<T, ENTRY>::DoOctetInput( const MYSTR **label, int iLabelLines, uint8_t *pOctets, int iCount )
+{
+  m_editor.SetOctets( pOctets, iCount );
+  StartInput( label, iLabelLines );
+}
+
+//Shows the label and the value being edited, the editor has been set up.
+template <class T, class ENTRY>
+template <typename MYSTR>
+void MenuManager<T, ENTRY>::StartInput( const MYSTR **label, int iLabelLines )
+{
+  char buff[MENU_EDIT_BUF_SIZE];
+  m_fDoingIntInput = true;
+  m_fMenuShown = false;
   //print the label
   m_pMenuLCD->PrintMenu( label, iLabelLines, -1 );
   m_iIntLine = iLabelLines;  //Off by one because index is zero based
-  itoa( m_pMenuIntHelper->getInt(), buff, 10 );
+  m_editor.Format( buff, sizeof( buff ) );
   DrawInputRow( buff );
 }
 
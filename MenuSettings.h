@@ -0,0 +1,330 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuSettings_h
+#define MenuSettings_h 1
+
+#include <Arduino.h>
+
+//Most values and bytes one MenuSettings can hold.
+#ifndef MENU_SETTINGS_MAX_VALUES
+#define MENU_SETTINGS_MAX_VALUES 16
+#endif
+#ifndef MENU_SETTINGS_MAX_BYTES
+#define MENU_SETTINGS_MAX_BYTES 32
+#endif
+//How long the values must stay unchanged before Update() saves them.
+#define MENU_SETTINGS_IDLE_MILLIS 5000
+
+//Byte access to the non-volatile memory.  MenuSettingsEEPROM.h has the EEPROM versions,
+//MenuSettingsFile.h keeps the bytes in a file for builds on a PC.
+typedef uint8_t (*MENU_STORE_READ_FUNC)( int iAddress );
+typedef void (*MENU_STORE_WRITE_FUNC)( int iAddress, uint8_t value );
+
+//Keeps variables edited through the menu across resets.
+//
+//Bind the variables, then Load() once at startup to restore them.  Changes are only held in the
+//variables themselves until they are saved.  MarkDirty() says a value may have changed: Update() then
+//saves once nothing has been marked for the idle time, or on its next call after MarkDirty( true ).
+//MenuManager marks every edit step, and the end of an edit for saving straight away (see
+//MenuManager::setSettings).  So stepping a number up and down writes nothing until the edit is over,
+//and while nothing is marked Update() costs next to nothing.
+//
+//Update() writes one byte per call, so a save never holds up loop() for more than one byte write
+//(about 3.3 ms on AVR EEPROM).  Commit() saves right away instead and blocks for the whole record,
+//3.3 ms per byte: about 115 ms for 32 bytes of values.
+//
+//Each Commit() writes a whole snapshot of the values, with a sequence number and a CRC, to the next
+//record in the region after the previous one.  The writes go round the region so every cell wears
+//at the same rate, and a snapshot cut short by a reset fails its CRC while the previous one is still there.
+//Load() picks the valid record with the newest sequence number.
+class MenuSettings
+{
+  public:
+  MenuSettings( MENU_STORE_READ_FUNC pRead, MENU_STORE_WRITE_FUNC pWrite, int iBase, int iLength );
+
+  //Adds a variable to the snapshot.  Bind everything before Load(), in the same order on every
+  //build: changing the set of values makes the stored records unreadable and the defaults are kept.
+  bool bind( void *pValue, uint8_t iSize );
+  template <class V> bool bind( V *pValue ) { return bind( (void *)pValue, sizeof( V ) ); }
+  //Restores the newest saved snapshot into the bound variables.  Returns false if there is none,
+  //the variables then keep the values they had.
+  bool Load();
+  //Saves the bound variables now if they changed since they were last loaded or saved, finishing
+  //a save Update() has started first.  Blocks until written.  Returns true if it wrote.
+  bool Commit();
+  //A bound variable may have changed.  Cheap, call it on every change.  fSaveNow skips the idle wait.
+  void MarkDirty( bool fSaveNow = false );
+  //Call from loop().  Starts a save when one is due and writes the next byte of a save in progress.
+  void Update( unsigned long ulNowMillis );
+  void setIdleMillis( unsigned long ulIdleMillis );
+  //Compares the variables with what was last loaded or saved.
+  bool isDirty();
+  //True while Update() is still writing a record.
+  bool isWriting() { return m_iWritePos >= 0; }
+  uint16_t getSequence() { return m_uSequence; }
+  //How many snapshots fit in the region.  Each one is the bound bytes plus 3.
+  int getRecordCount();
+
+  private:
+  int getRecordSize() { return m_iPayload + 3; }
+  void Gather( uint8_t *pBuf );
+  static uint8_t Crc( uint8_t crc, const uint8_t *pData, int iSize );
+  uint8_t RecordCrc( uint16_t uSequence, const uint8_t *pPayload );
+  bool BeginWrite();
+  void WriteNext();
+
+  MENU_STORE_READ_FUNC m_pRead;
+  MENU_STORE_WRITE_FUNC m_pWrite;
+  int m_iBase;
+  int m_iLength;
+  void *m_pValues[MENU_SETTINGS_MAX_VALUES];
+  uint8_t m_sizes[MENU_SETTINGS_MAX_VALUES];
+  uint8_t m_nValues;
+  int m_iPayload;
+  //The values as they were last loaded or saved.
+  uint8_t m_saved[MENU_SETTINGS_MAX_BYTES];
+  uint16_t m_uSequence;
+  int m_iNextRecord;
+  //The record being written: its address, the next byte to write or -1, and its CRC.
+  int m_iWriteAddress;
+  int m_iWritePos;
+  uint8_t m_writeCrc;
+  //For the idle save: set by MarkDirty, m_fMarked until Update() has noted the time.
+  bool m_fDirty;
+  bool m_fMarked;
+  bool m_fSaveNow;
+  unsigned long m_ulChangedMillis;
+  unsigned long m_ulIdleMillis;
+};
+
+inline MenuSettings::MenuSettings( MENU_STORE_READ_FUNC pRead, MENU_STORE_WRITE_FUNC pWrite, int iBase, int iLength ):
+  m_pRead( pRead ),
+  m_pWrite( pWrite ),
+  m_iBase( iBase ),
+  m_iLength( iLength ),
+  m_nValues( 0 ),
+  m_iPayload( 0 ),
+  m_uSequence( 0 ),
+  m_iNextRecord( 0 ),
+  m_iWriteAddress( 0 ),
+  m_iWritePos( -1 ),
+  m_writeCrc( 0 ),
+  m_fDirty( false ),
+  m_fMarked( false ),
+  m_fSaveNow( false ),
+  m_ulChangedMillis( 0 ),
+  m_ulIdleMillis( MENU_SETTINGS_IDLE_MILLIS )
+{
+}
+
+inline bool MenuSettings::bind( void *pValue, uint8_t iSize )
+{
+  if( m_nValues == MENU_SETTINGS_MAX_VALUES || m_iPayload + iSize > MENU_SETTINGS_MAX_BYTES )
+  {
+    return false;
+  }
+  m_pValues[m_nValues] = pValue;
+  m_sizes[m_nValues++] = iSize;
+  m_iPayload += iSize;
+  return true;
+}
+
+inline int MenuSettings::getRecordCount()
+{
+  return m_iLength / getRecordSize();
+}
+
+inline void MenuSettings::Gather( uint8_t *pBuf )
+{
+  for( int i = 0; i < m_nValues; ++i )
+  {
+    memcpy( pBuf, m_pValues[i], m_sizes[i] );
+    pBuf += m_sizes[i];
+  }
+}
+
+//CRC-8, polynomial 0x31 reflected (Dallas/Maxim)
+inline uint8_t MenuSettings::Crc( uint8_t crc, const uint8_t *pData, int iSize )
+{
+  while( iSize-- > 0 )
+  {
+    crc ^= *pData++;
+    for( int i = 0; i < 8; ++i )
+    {
+      crc = ( crc & 1 ) ? ( crc >> 1 ) ^ 0x8C : crc >> 1;
+    }
+  }
+  return crc;
+}
+
+//The payload size is part of the CRC, so records written for another set of values don't load.
+inline uint8_t MenuSettings::RecordCrc( uint16_t uSequence, const uint8_t *pPayload )
+{
+  uint8_t header[3] = { (uint8_t)m_iPayload, (uint8_t)uSequence, (uint8_t)( uSequence >> 8 ) };
+  return Crc( Crc( 0, header, 3 ), pPayload, m_iPayload );
+}
+
+inline bool MenuSettings::Load()
+{
+  uint8_t buff[MENU_SETTINGS_MAX_BYTES];
+  int iRecordSize = getRecordSize();
+  int iNewest = -1;
+  for( int iRecord = 0; iRecord < getRecordCount(); ++iRecord )
+  {
+    int iAddress = m_iBase + iRecord * iRecordSize;
+    uint16_t uSequence = m_pRead( iAddress ) | ( m_pRead( iAddress + 1 ) << 8 );
+    for( int i = 0; i < m_iPayload; ++i )
+    {
+      buff[i] = m_pRead( iAddress + 2 + i );
+    }
+    if( m_pRead( iAddress + 2 + m_iPayload ) != RecordCrc( uSequence, buff ) )
+    {
+      continue;
+    }
+    //sequence numbers wrap, newer means ahead by less than half the range
+    if( iNewest < 0 || (int16_t)( uSequence - m_uSequence ) > 0 )
+    {
+      iNewest = iRecord;
+      m_uSequence = uSequence;
+      memcpy( m_saved, buff, m_iPayload );
+    }
+  }
+  if( iNewest < 0 )
+  {
+    m_uSequence = 0;
+    m_iNextRecord = 0;
+    Gather( m_saved );
+    return false;
+  }
+  const uint8_t *pSaved = m_saved;
+  for( int i = 0; i < m_nValues; ++i )
+  {
+    memcpy( m_pValues[i], pSaved, m_sizes[i] );
+    pSaved += m_sizes[i];
+  }
+  m_iNextRecord = ( iNewest + 1 ) % getRecordCount();
+  return true;
+}
+
+inline bool MenuSettings::isDirty()
+{
+  uint8_t buff[MENU_SETTINGS_MAX_BYTES];
+  Gather( buff );
+  return memcmp( buff, m_saved, m_iPayload ) != 0;
+}
+
+//Takes a snapshot of the values into m_saved and sets up the record for WriteNext().
+//Returns false if nothing changed.  The record goes to the oldest slot, so until its CRC is
+//written the previous snapshot is still the newest valid one.
+inline bool MenuSettings::BeginWrite()
+{
+  if( getRecordCount() == 0 || !isDirty() )
+  {
+    return false;
+  }
+  Gather( m_saved );
+  ++m_uSequence;
+  m_writeCrc = RecordCrc( m_uSequence, m_saved );
+  m_iWriteAddress = m_iBase + m_iNextRecord * getRecordSize();
+  m_iWritePos = 0;
+  m_iNextRecord = ( m_iNextRecord + 1 ) % getRecordCount();
+  return true;
+}
+
+//Sequence number, payload, then the CRC last: the record only counts once it is complete.
+inline void MenuSettings::WriteNext()
+{
+  uint8_t value;
+  if( m_iWritePos < 2 )
+  {
+    value = (uint8_t)( m_uSequence >> ( 8 * m_iWritePos ) );
+  }
+  else if( m_iWritePos < 2 + m_iPayload )
+  {
+    value = m_saved[m_iWritePos - 2];
+  }
+  else
+  {
+    value = m_writeCrc;
+  }
+  m_pWrite( m_iWriteAddress + m_iWritePos, value );
+  if( ++m_iWritePos == getRecordSize() )
+  {
+    m_iWritePos = -1;
+  }
+}
+
+inline bool MenuSettings::Commit()
+{
+  bool fWrote = isWriting();
+  while( isWriting() )
+  {
+    WriteNext();
+  }
+  m_fDirty = false;
+  m_fSaveNow = false;
+  if( BeginWrite() )
+  {
+    fWrote = true;
+    while( isWriting() )
+    {
+      WriteNext();
+    }
+  }
+  return fWrote;
+}
+
+inline void MenuSettings::MarkDirty( bool fSaveNow )
+{
+  m_fDirty = true;
+  m_fMarked = true;
+  m_fSaveNow = m_fSaveNow || fSaveNow;
+}
+
+inline void MenuSettings::Update( unsigned long ulNowMillis )
+{
+  if( isWriting() )
+  {
+    WriteNext();
+    return;
+  }
+  if( !m_fDirty )
+  {
+    return;
+  }
+  if( m_fMarked )
+  {
+    m_fMarked = false;
+    m_ulChangedMillis = ulNowMillis;
+  }
+  if( m_fSaveNow || ulNowMillis - m_ulChangedMillis >= m_ulIdleMillis )
+  {
+    m_fDirty = false;
+    m_fSaveNow = false;
+    BeginWrite();
+  }
+}
+
+inline void MenuSettings::setIdleMillis( unsigned long ulIdleMillis )
+{
+  m_ulIdleMillis = ulIdleMillis;
+}
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuSettingsEEPROM_h
+#define MenuSettingsEEPROM_h 1
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "MenuSettings.h"
+
+//MenuSettings storage in the on-chip EEPROM:
+//  MenuSettings g_settings( MenuSettingsEEPROM_Read, MenuSettingsEEPROM_Write, 0, 256 );
+//update() skips bytes that already hold the value.  Cores that emulate EEPROM in flash
+//(ESP8266, ESP32) also need EEPROM.begin() at startup, and EEPROM.commit() after g_settings.Commit()
+//or once isWriting() turns false.
+inline uint8_t MenuSettingsEEPROM_Read( int iAddress )
+{
+  return EEPROM.read( iAddress );
+}
+
+inline void MenuSettingsEEPROM_Write( int iAddress, uint8_t value )
+{
+  EEPROM.update( iAddress, value );
+}
+
+#endif
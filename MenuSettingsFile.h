@@ -0,0 +1,79 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuSettingsFile_h
+#define MenuSettingsFile_h 1
+
+#include <stdio.h>
+#include "MenuSettings.h"
+
+//MenuSettings storage in a file, for running the menu on a PC:
+//  MenuSettingsFile_Open( "settings.bin", 256 );
+//  MenuSettings g_settings( MenuSettingsFile_Read, MenuSettingsFile_Write, 0, 256 );
+//A new file is filled with 0xFF like erased EEPROM.  Every write is flushed, so killing
+//the program behaves like pulling the power.
+inline FILE *&MenuSettingsFile_Handle()
+{
+  static FILE *s_pFile = NULL;
+  return s_pFile;
+}
+
+inline bool MenuSettingsFile_Open( const char *pPath, int iSize )
+{
+  FILE *&pFile = MenuSettingsFile_Handle();
+  pFile = fopen( pPath, "r+b" );
+  if( pFile == NULL )
+  {
+    pFile = fopen( pPath, "w+b" );
+    if( pFile == NULL )
+    {
+      return false;
+    }
+    for( int i = 0; i < iSize; ++i )
+    {
+      fputc( 0xFF, pFile );
+    }
+    fflush( pFile );
+  }
+  return true;
+}
+
+inline uint8_t MenuSettingsFile_Read( int iAddress )
+{
+  FILE *pFile = MenuSettingsFile_Handle();
+  if( pFile == NULL || fseek( pFile, iAddress, SEEK_SET ) != 0 )
+  {
+    return 0xFF;
+  }
+  int c = fgetc( pFile );
+  return c == EOF ? 0xFF : (uint8_t)c;
+}
+
+inline void MenuSettingsFile_Write( int iAddress, uint8_t value )
+{
+  FILE *pFile = MenuSettingsFile_Handle();
+  if( pFile == NULL || fseek( pFile, iAddress, SEEK_SET ) != 0 )
+  {
+    return;
+  }
+  fputc( value, pFile );
+  fflush( pFile );
+}
+
+#endif
@@ -0,0 +1,110 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MenuStats_h
+#define MenuStats_h 1
+
+#include <Arduino.h>
+#include "MenuAction.h"
+
+//Field profiling for MenuManager and MenuLCD.  It is compiled out unless the sketch has
+//  #define MENU_ENABLE_STATS 1
+//before it includes any of the menu headers.  Then MenuManager::getStats() returns the
+//numbers and MenuManager::PrintStats( Serial ) dumps them.
+#ifndef MENU_ENABLE_STATS
+#define MENU_ENABLE_STATS 0
+#endif
+
+#if MENU_ENABLE_STATS
+#define MENU_STATS_START( var ) unsigned long var = micros()
+#define MENU_STATS_RECORD( timing, var ) (timing).Record( micros() - (var) )
+#define MENU_STATS_COUNT( counter ) ++(counter)
+#else
+#define MENU_STATS_START( var )
+#define MENU_STATS_RECORD( timing, var )
+#define MENU_STATS_COUNT( counter )
+#endif
+
+#define MENU_ACTION_COUNT ( MENU_ACTION_SEEK + 1 )
+
+//count and min/avg/max of one kind of event, in microseconds
+struct MenuTiming
+{
+  unsigned long count;
+  unsigned long minMicros;
+  unsigned long maxMicros;
+  unsigned long totalMicros;
+
+  void Record( unsigned long ulMicros )
+  {
+    if( count == 0 || ulMicros < minMicros )
+    {
+      minMicros = ulMicros;
+    }
+    if( ulMicros > maxMicros )
+    {
+      maxMicros = ulMicros;
+    }
+    totalMicros += ulMicros;
+    ++count;
+  }
+  unsigned long getAvgMicros() const { return count == 0 ? 0 : totalMicros / count; }
+  void Dump( Print &out, const char *pName ) const
+  {
+    out.print( pName );
+    out.print( F(": n=") );
+    out.print( count );
+    out.print( F(" min=") );
+    out.print( minMicros );
+    out.print( F(" avg=") );
+    out.print( getAvgMicros() );
+    out.print( F(" max=") );
+    out.println( maxMicros );
+  }
+};
+
+struct MenuStats
+{
+  MenuTiming actions[MENU_ACTION_COUNT];  //DoMenuAction, indexed by MENU_ACTION
+  MenuTiming draws;                        //DrawMenu
+  MenuTiming wipes;                        //start to end of each wipe transition
+  MenuTiming callbacks;                    //time spent in the menu entries' callbacks
+  unsigned long lcdChars;                  //characters MenuLCD sent to the display
+  unsigned long lcdCursorMoves;            //setCursor calls MenuLCD made
+
+  void Dump( Print &out ) const
+  {
+    static const char * const names[MENU_ACTION_COUNT] = { "none", "up", "down", "select", "back",
+                                                           "page up", "page down", "first", "last", "jump", "seek" };
+    for( int i = 0; i < MENU_ACTION_COUNT; ++i )
+    {
+      actions[i].Dump( out, names[i] );
+    }
+    draws.Dump( out, "draw" );
+    wipes.Dump( out, "wipe" );
+    callbacks.Dump( out, "callback" );
+    out.print( F("lcd chars=") );
+    out.print( lcdChars );
+    out.print( F(" cursor moves=") );
+    out.println( lcdCursorMoves );
+  }
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MenuTable_h
+#define MenuTable_h 1
+
+#include <Arduino.h>
+#include "MenuEntry.h"
+
+//A menu tree that is built by the compiler and lives in flash.
+//
+//Describe the tree as an array of MenuTableItem in depth-first order, giving each entry its depth
+//(0 for the top level, 1 for its children and so on).  The first item must have depth 0 and the
+//depth can only grow by one from one item to the next.  Texts must be PROGMEM strings.
+//
+//  const char s_stopwatch[] PROGMEM = "Stopwatch";
+//  ...
+//  constexpr MenuTableItem g_items[] = {
+//    { 0, s_stopwatch, NULL,               NULL },
+//    { 1, s_start,     WatchStartCallback, NULL },
+//    { 1, s_back,      MenuEntry_BackCallbackFunc<LiquidCrystal>, NULL },
+//    { 0, s_credits,   CreditsCallback,    NULL } };
+//  const MenuTable<LiquidCrystal, MENU_TABLE_SIZE(g_items)> g_table PROGMEM = MenuBuildTable<LiquidCrystal>( g_items );
+//
+//  MenuManager<LiquidCrystal, const MenuTableEntry<LiquidCrystal> > g_menuManager( &g_menuLCD );
+//  g_menuManager.addMenuRoot( g_table.getRoot() );
+//
+//The parent/child/sibling links are worked out at compile time, so nothing is allocated or
+//constructed at startup and no SRAM is used per entry.  Callbacks get the PROGMEM text pointer.
+struct MenuTableItem
+{
+  uint8_t depth;
+  const char *text;
+  MENU_ACTION_CALLBACK_FUNC callback;
+  void *userData;
+};
+
+#define MENU_TABLE_SIZE( items ) ( sizeof( items ) / sizeof( (items)[0] ) )
+
+//One node of the flash table.  The links are offsets from this node, 0 meaning no link, so a node
+//can find its neighbours without knowing where the table starts.  Every read goes through pgm_read_*.
+template <class T>
+class MenuTableEntry
+{
+  public:
+  constexpr MenuTableEntry( const char *menuText, MENU_ACTION_CALLBACK_FUNC func, void *userData,
+                            int16_t parent, int16_t child, int16_t nextSibling, int16_t prevSibling ):
+    m_menuText( menuText ), m_callback( func ), m_userData( userData ),
+    m_parent( parent ), m_child( child ), m_nextSibling( nextSibling ), m_prevSibling( prevSibling ) {}
+
+  const char* getMenuText() const { return (const char *)pgm_read_ptr( &m_menuText ); }
+  bool isProgMem() const { return true; }
+
+  const MenuTableEntry<T> *getNextSibling() const { return Link( &m_nextSibling ); }
+  const MenuTableEntry<T> *getPrevSibling() const { return Link( &m_prevSibling ); }
+  const MenuTableEntry<T> *getChild() const { return Link( &m_child ); }
+  const MenuTableEntry<T> *getParent() const { return Link( &m_parent ); }
+
+  MENU_ACTION_RESULT ExecuteCallback() const;
+  bool isBackEntry() const { return ( getCallback() == MenuEntry_BackCallbackFunc<T> ); }
+  MenuVirtualList *getVirtualList() const
+  {
+    return getCallback() == MenuEntry_VirtualListCallbackFunc ? (MenuVirtualList *)pgm_read_ptr( &m_userData ) : NULL;
+  }
+
+  private:
+  MENU_ACTION_CALLBACK_FUNC getCallback() const { return (MENU_ACTION_CALLBACK_FUNC)pgm_read_ptr( &m_callback ); }
+  const MenuTableEntry<T> *Link( const int16_t *pOffset ) const
+  {
+    int16_t offset = (int16_t)pgm_read_word( pOffset );
+    return offset == 0 ? NULL : this + offset;
+  }
+
+  const char *m_menuText;
+  MENU_ACTION_CALLBACK_FUNC m_callback;
+  void *m_userData;
+  int16_t m_parent;
+  int16_t m_child;
+  int16_t m_nextSibling;
+  int16_t m_prevSibling;
+};
+
+template <class T>
+MENU_ACTION_RESULT MenuTableEntry<T>::ExecuteCallback() const
+{
+  MENU_ACTION_CALLBACK_FUNC callback = getCallback();
+  if( callback != NULL )
+  {
+    return callback( getMenuText(), pgm_read_ptr( &m_userData ) );
+  }
+  return MENU_ACTION_RESULT_NONE;
+}
+
+//The flattened table.  Declare it const and PROGMEM, initialised from MenuBuildTable.
+template <class T, unsigned N>
+struct MenuTable
+{
+  MenuTableEntry<T> entries[N];
+
+  const MenuTableEntry<T> *getRoot() const { return &entries[0]; }
+};
+
+//Compile time helpers for MenuBuildTable.  Written as single-return recursions so they work as C++11 constexpr.
+template <unsigned... Is>
+struct MenuIndexSeq {};
+
+template <unsigned N, unsigned... Is>
+struct MenuMakeIndexSeq : MenuMakeIndexSeq<N - 1, N - 1, Is...> {};
+
+template <unsigned... Is>
+struct MenuMakeIndexSeq<0, Is...> { typedef MenuIndexSeq<Is...> type; };
+
+//Nearest item at or before j whose depth is <= depth, or -1.
+constexpr int MenuTableFindBack( const MenuTableItem *items, int j, int depth )
+{
+  return j < 0 ? -1 : ( items[j].depth <= depth ? j : MenuTableFindBack( items, j - 1, depth ) );
+}
+
+//Nearest item at or after j whose depth is <= depth, or -1.
+constexpr int MenuTableFindForward( const MenuTableItem *items, int n, int j, int depth )
+{
+  return j >= n ? -1 : ( items[j].depth <= depth ? j : MenuTableFindForward( items, n, j + 1, depth ) );
+}
+
+//Turns the index of a sibling candidate into an offset from i, 0 if it is not on i's level.
+constexpr int16_t MenuTableSiblingOffset( const MenuTableItem *items, int i, int j )
+{
+  return ( j < 0 || items[j].depth != items[i].depth ) ? 0 : (int16_t)( j - i );
+}
+
+constexpr int16_t MenuTableParentOffset( const MenuTableItem *items, int i )
+{
+  return items[i].depth == 0 ? 0 : (int16_t)( MenuTableFindBack( items, i - 1, items[i].depth - 1 ) - i );
+}
+
+constexpr int16_t MenuTableChildOffset( const MenuTableItem *items, int n, int i )
+{
+  return ( i + 1 < n && items[i + 1].depth == items[i].depth + 1 ) ? 1 : 0;
+}
+
+template <class T>
+constexpr MenuTableEntry<T> MenuTableMakeEntry( const MenuTableItem *items, int n, int i )
+{
+  return MenuTableEntry<T>( items[i].text, items[i].callback, items[i].userData,
+                            MenuTableParentOffset( items, i ),
+                            MenuTableChildOffset( items, n, i ),
+                            MenuTableSiblingOffset( items, i, MenuTableFindForward( items, n, i + 1, items[i].depth ) ),
+                            MenuTableSiblingOffset( items, i, MenuTableFindBack( items, i - 1, items[i].depth ) ) );
+}
+
+template <class T, unsigned N, unsigned... Is>
+constexpr MenuTable<T, N> MenuBuildTable( const MenuTableItem ( &items )[N], MenuIndexSeq<Is...> )
+{
+  return MenuTable<T, N>{ { MenuTableMakeEntry<T>( items, N, Is )... } };
+}
+
+template <class T, unsigned N>
+constexpr MenuTable<T, N> MenuBuildTable( const MenuTableItem ( &items )[N] )
+{
+  return MenuBuildTable<T>( items, typename MenuMakeIndexSeq<N>::type() );
+}
+
+#endif
@@ -0,0 +1,276 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuTrace_h
+#define MenuTrace_h 1
+
+#include <Arduino.h>
+#include "MenuAction.h"
+#include "MenuBusCounter.h"
+
+//One recorded action: what, how many times (DoMenuAction's iCount), and how many milliseconds
+//after the previous recorded action.
+struct MenuTraceEvent
+{
+  MENU_ACTION action;
+  unsigned int count;
+  unsigned long deltaMillis;
+};
+
+//Records the actions MenuManager handles into a ring of bytes you provide, so the last few
+//hundred presses before a problem can be dumped and replayed (see MenuTraceReplay below).
+//
+//  uint8_t g_traceBuffer[256];
+//  MenuTrace g_trace( g_traceBuffer, sizeof( g_traceBuffer ) );
+//  ...
+//  menuController.setTrace( &g_trace );
+//  ...
+//  g_trace.Dump( Serial );
+//
+//Each event is 2 bytes for a single action less than 128 ms after the previous one, more for
+//longer gaps or repeated actions: a byte with the action (bits 0-3) and a repeat flag (bit 4), the
+//delta as a base-128 varint, then count - 1 as a varint if the flag is set.
+//When the ring is full the oldest events are dropped.
+class MenuTrace
+{
+  public:
+  MenuTrace( uint8_t *pBuffer, unsigned int iSize );
+
+  void Record( MENU_ACTION action, unsigned int iCount, unsigned long ulNowMillis );
+  void Clear();
+  //Bytes of events held, and the events in order from the oldest, for MenuTraceReader.
+  unsigned int getUsed() { return m_iUsed; }
+  unsigned int CopyTo( uint8_t *pDest, unsigned int iMax );
+  //Prints the events as a C array initialiser between "menutrace" and "end", ready to paste
+  //into a replay sketch.
+  void Dump( Print &out );
+
+  private:
+  uint8_t getByte( unsigned int iOffset ) { return m_pBuffer[( m_iTail + iOffset ) % m_iSize]; }
+  void DropOldest();
+
+  uint8_t *m_pBuffer;
+  unsigned int m_iSize;
+  unsigned int m_iTail;
+  unsigned int m_iUsed;
+  unsigned long m_ulLastMillis;
+  bool m_fHaveLast;
+};
+
+//Walks events in the byte format above, e.g. from MenuTrace::CopyTo or a pasted dump.
+class MenuTraceReader
+{
+  public:
+  MenuTraceReader( const uint8_t *pData, unsigned int iSize ): m_pData( pData ), m_iSize( iSize ), m_iPos( 0 ) {}
+  //Returns false at the end, or on a cut off event.
+  bool Next( MenuTraceEvent *pEvent );
+  void Rewind() { m_iPos = 0; }
+
+  private:
+  bool ReadVarint( unsigned long *pValue );
+
+  const uint8_t *m_pData;
+  unsigned int m_iSize;
+  unsigned int m_iPos;
+};
+
+#define MENU_TRACE_REPEAT 0x10
+
+//Appends v as a base-128 varint to pOut, returns the bytes used (at most 5).
+inline int MenuTrace_PutVarint( uint8_t *pOut, unsigned long v )
+{
+  int n = 0;
+  while( v >= 0x80 )
+  {
+    pOut[n++] = (uint8_t)( v | 0x80 );
+    v >>= 7;
+  }
+  pOut[n++] = (uint8_t)v;
+  return n;
+}
+
+inline MenuTrace::MenuTrace( uint8_t *pBuffer, unsigned int iSize ):
+  m_pBuffer( pBuffer ),
+  m_iSize( iSize ),
+  m_iTail( 0 ),
+  m_iUsed( 0 ),
+  m_ulLastMillis( 0 ),
+  m_fHaveLast( false )
+{
+}
+
+inline void MenuTrace::Clear()
+{
+  m_iTail = 0;
+  m_iUsed = 0;
+  m_fHaveLast = false;
+}
+
+inline void MenuTrace::Record( MENU_ACTION action, unsigned int iCount, unsigned long ulNowMillis )
+{
+  uint8_t event[11];
+  int n = 0;
+  event[n++] = ( action & 0x0F ) | ( iCount > 1 ? MENU_TRACE_REPEAT : 0 );
+  n += MenuTrace_PutVarint( event + n, m_fHaveLast ? ulNowMillis - m_ulLastMillis : 0 );
+  if( iCount > 1 )
+  {
+    n += MenuTrace_PutVarint( event + n, iCount - 1 );
+  }
+  if( (unsigned int)n > m_iSize )
+  {
+    return;
+  }
+  while( m_iSize - m_iUsed < (unsigned int)n )
+  {
+    DropOldest();
+  }
+  for( int i = 0; i < n; ++i )
+  {
+    m_pBuffer[( m_iTail + m_iUsed++ ) % m_iSize] = event[i];
+  }
+  m_ulLastMillis = ulNowMillis;
+  m_fHaveLast = true;
+}
+
+inline void MenuTrace::DropOldest()
+{
+  unsigned int iLen = 1;
+  bool fRepeat = ( getByte( 0 ) & MENU_TRACE_REPEAT ) != 0;
+  while( iLen < m_iUsed && ( getByte( iLen ) & 0x80 ) )
+  {
+    ++iLen;
+  }
+  ++iLen;
+  if( fRepeat )
+  {
+    while( iLen < m_iUsed && ( getByte( iLen ) & 0x80 ) )
+    {
+      ++iLen;
+    }
+    ++iLen;
+  }
+  if( iLen > m_iUsed )
+  {
+    iLen = m_iUsed;
+  }
+  m_iTail = ( m_iTail + iLen ) % m_iSize;
+  m_iUsed -= iLen;
+}
+
+inline unsigned int MenuTrace::CopyTo( uint8_t *pDest, unsigned int iMax )
+{
+  unsigned int n = m_iUsed < iMax ? m_iUsed : iMax;
+  for( unsigned int i = 0; i < n; ++i )
+  {
+    pDest[i] = getByte( i );
+  }
+  return n;
+}
+
+inline void MenuTrace::Dump( Print &out )
+{
+  out.println( F( "menutrace" ) );
+  for( unsigned int i = 0; i < m_iUsed; ++i )
+  {
+    uint8_t b = getByte( i );
+    out.print( F( "0x" ) );
+    if( b < 0x10 )
+    {
+      out.print( '0' );
+    }
+    out.print( b, HEX );
+    out.print( ( i % 16 == 15 || i + 1 == m_iUsed ) ? F( ",\n" ) : F( ", " ) );
+  }
+  out.println( F( "end" ) );
+}
+
+inline bool MenuTraceReader::ReadVarint( unsigned long *pValue )
+{
+  unsigned long v = 0;
+  for( int iShift = 0; m_iPos < m_iSize && iShift < 35; iShift += 7 )
+  {
+    uint8_t b = m_pData[m_iPos++];
+    v |= (unsigned long)( b & 0x7F ) << iShift;
+    if( !( b & 0x80 ) )
+    {
+      *pValue = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline bool MenuTraceReader::Next( MenuTraceEvent *pEvent )
+{
+  if( m_iPos >= m_iSize )
+  {
+    return false;
+  }
+  uint8_t head = m_pData[m_iPos++];
+  unsigned long ulCount = 0;
+  if( !ReadVarint( &pEvent->deltaMillis ) || ( ( head & MENU_TRACE_REPEAT ) && !ReadVarint( &ulCount ) ) )
+  {
+    return false;
+  }
+  pEvent->action = (MENU_ACTION)( head & 0x0F );
+  pEvent->count = (unsigned int)ulCount + 1;
+  return true;
+}
+
+//Feeds a trace through manager.DoMenuAction and prints one CSV line per event with what it
+//cost on the display bus, then the screen the trace ends on:
+//  event,action,count,delta_ms,commands,chars,cursor,clears,bus_us
+//counter is the MenuBusCounter the manager's MenuLCD draws through.  The gaps are replayed on a
+//clock of their own: manager.Update() is called once before each action with the time it came at,
+//so anything timed, such as an idle save, sees the same gaps, and what it draws counts to that event.
+template <class MANAGER, class MENULCD, class COUNTER>
+void MenuTraceReplay( MenuTraceReader &reader, MANAGER &manager, MENULCD &menuLCD, COUNTER &counter, Print &out )
+{
+  out.println( F( "event,action,count,delta_ms,commands,chars,cursor,clears,bus_us" ) );
+  MenuTraceEvent event;
+  unsigned long ulClock = millis();
+  for( int i = 0; reader.Next( &event ); ++i )
+  {
+    counter.resetStats();
+    ulClock += event.deltaMillis;
+    manager.Update( ulClock );
+    manager.DoMenuAction( event.action, event.count );
+    const MenuBusStats &stats = counter.getStats();
+    out.print( i );
+    out.print( ',' );
+    out.print( (int)event.action );
+    out.print( ',' );
+    out.print( event.count );
+    out.print( ',' );
+    out.print( event.deltaMillis );
+    out.print( ',' );
+    out.print( stats.commands );
+    out.print( ',' );
+    out.print( stats.chars );
+    out.print( ',' );
+    out.print( stats.cursorMoves );
+    out.print( ',' );
+    out.print( stats.clears );
+    out.print( ',' );
+    out.println( stats.busMicros );
+  }
+  menuLCD.DumpScreen( out );
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef MenuVirtualList_h
+#define MenuVirtualList_h 1
+
+#include <Arduino.h>
+#include "MenuAction.h"
+
+//Longest row text MenuManager asks textAt() for, terminator included.
+#ifndef MENU_LIST_TEXT_SIZE
+#define MENU_LIST_TEXT_SIZE 21
+#endif
+
+//A list whose rows are generated on demand instead of being MenuEntry objects, for long or
+//changing lists such as files, stored profiles or scan results.  Only the rows on screen are asked for,
+//so the list costs the same memory whatever its length.
+//
+//  count( pUserData )                          how many rows there are now.
+//  textAt( iIndex, pBuf, iBufSize, pUserData ) writes row iIndex into pBuf, at most iBufSize bytes with the terminator.
+//  select( iIndex, pUserData )                 called on SELECT, may be NULL.
+//
+//Hang it off a normal entry with MenuEntry_VirtualListCallbackFunc as the callback and the list as the
+//user data.  Selecting that entry browses the list, BACK returns to the entry.
+typedef int (*MENU_LIST_COUNT_FUNC)( void * pUserData );
+typedef void (*MENU_LIST_TEXT_FUNC)( int iIndex, char * pBuf, int iBufSize, void * pUserData );
+typedef MENU_ACTION_RESULT (*MENU_LIST_SELECT_FUNC)( int iIndex, void * pUserData );
+
+struct MenuVirtualList
+{
+  MENU_LIST_COUNT_FUNC count;
+  MENU_LIST_TEXT_FUNC textAt;
+  MENU_LIST_SELECT_FUNC select;
+  void *pUserData;
+};
+
+//Marks an entry as the way into a MenuVirtualList.  MenuManager recognises it and never calls it.
+inline MENU_ACTION_RESULT MenuEntry_VirtualListCallbackFunc( const char * pMenuText, void * pUserData )
+{
+  return MENU_ACTION_RESULT_NONE;
+}
+
+#endif
@@ -24,6 +24,7 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSI
 #include "MenuEntry.h"
 #include "MenuLCD.h"
 #include "MenuManager.h"
+#include "MenuBind.h"
 
 //This example is a Stopwatch and Timer.  Although it is mostly functional, it might not be the best
 // user interface.  The layout was created more to provide examples of a stopwatch/timer.
@@ -51,6 +52,10 @@ long g_autoReset = false;
 long g_stopMillis = 0;
 long g_startMillis = 0;
 
+//ids for MenuLCD::registerGlyph/getGlyph
+const uint8_t GLYPH_SMILEY = 0;
+const uint8_t GLYPH_FROWN = 1;
+
 byte g_smiley[8] = {
   B00000,
   B10001,
@@ -126,9 +131,9 @@ void setupMenus()
   g_menuManager.MenuDown();
 
   //Add "AutoReset"'s children
-  //Use the built-in BOOL setting callbacks from MenuEntry.h: MenuEntry_Bool*CallbackFunc
-  g_menuManager.addChild( new MenuEntry( "Turn Reset On",  (void *) (&g_autoReset), MenuEntry_BoolTrueCallbackFunc ) );
-  g_menuManager.addChild( new MenuEntry( "Turn Reset Off", (void *) (&g_autoReset), MenuEntry_BoolFalseCallbackFunc ) );
+  //Use the value setting callbacks from MenuBind.h, the variable is bound at compile time so no user data is needed
+  g_menuManager.addChild( new MenuEntry( "Turn Reset On",  NULL, MenuAction_Set<long, &g_autoReset, true> ) );
+  g_menuManager.addChild( new MenuEntry( "Turn Reset Off", NULL, MenuAction_Set<long, &g_autoReset, false> ) );
   g_menuManager.addChild( new MenuEntry("Back", (void *) &g_menuManager, MenuEntry_BackCallbackFunc) );
 
   //Add timer start and stop
@@ -144,8 +149,8 @@ void setupMenus()
 
   g_menuManager.addSibling( new MenuEntry( "Draw Smiley", NULL, SmileyCallback) );
   
-  g_menuLCD.getLCD()->createChar( 0, g_smiley );
-  g_menuLCD.getLCD()->createChar( 1, g_frown );
+  g_menuLCD.registerGlyph( GLYPH_SMILEY, g_smiley );
+  g_menuLCD.registerGlyph( GLYPH_FROWN, g_frown );
 }
 
 
@@ -302,16 +307,16 @@ void CreditsCallback( char* pMenuText, void *pUserData )
 
 void SmileyCallback( char* pMenuText, void *pUserData )
 {
+  char szFace[] = "         ";
+  g_menuLCD.ClearLCD();
   for( int i = 0; i < 10 ; ++i )
   {
-    g_menuLCD.ClearLCD();
-    g_menuLCD.getLCD()->setCursor( 8,0 );
-    g_menuLCD.getLCD()->print( (char)0 );
+    //only the face itself changes, so each frame is a single character on the bus
+    szFace[8] = g_menuLCD.getGlyph( GLYPH_SMILEY );
+    g_menuLCD.PrintLine( szFace, 0 );
     delay(500);
-    g_menuLCD.ClearLCD();
-    g_menuLCD.getLCD()->setCursor( 8,0 );
-    g_menuLCD.getLCD()->print( (char)1 );
+    szFace[8] = g_menuLCD.getGlyph( GLYPH_FROWN );
+    g_menuLCD.PrintLine( szFace, 0 );
     delay(500);
   }   
 }
-
@@ -0,0 +1,184 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MenuEntry.h"
+#include "MenuLCD.h"
+#include "MenuManager.h"
+#include "MenuBusCounter.h"
+
+//This example needs no LCD.  It builds synthetic menus, drives them with scripted button presses
+//and prints what each press cost on the display bus to the serial port:
+//  menu size, levels, script, presses, bus commands, characters, cursor moves, clears,
+//  estimated HD44780 busy time per press and measured CPU time per press (both in microseconds).
+//Run it before and after a change to the library to catch redraw or traversal regressions.
+
+typedef MenuBusCounter<MenuNullLCD> Counter;
+
+MenuNullLCD g_nullLCD;
+Counter g_counter( &g_nullLCD );
+MenuLCD<Counter> g_menuLCD( &g_counter, 20, 4 );
+
+#if defined(__AVR__)
+//1000 MenuEntry objects don't fit in 2K of SRAM
+const int g_sizes[] = { 10, 100 };
+#else
+const int g_sizes[] = { 10, 100, 1000 };
+#endif
+const int g_levels[] = { 1, 3 };
+
+//Labels are reused round robin.  There are enough of them that scrolling changes every row,
+//without needing RAM for a string per entry.
+const char *g_labels[] = { "Alpha", "Bravo", "Charlie", "Delta", "Echo", "Foxtrot", "Golf", "Hotel" };
+const int g_nLabels = sizeof( g_labels ) / sizeof( g_labels[0] );
+
+//Builds nEntries entries spread over nLevels levels: each level is a list whose first entry
+//holds the next level down.
+MenuEntry<Counter> *BuildMenu( MenuManager<Counter> &manager, int nEntries, int nLevels )
+{
+  MenuEntry<Counter> *pRoot = new MenuEntry<Counter>( g_labels[0], NULL, NULL );
+  manager.addMenuRoot( pRoot );
+  int iPerLevel = nEntries / nLevels;
+  int iMade = 1;
+  for( int iLevel = 0; iLevel < nLevels; ++iLevel )
+  {
+    for( int i = 1; i < iPerLevel && iMade < nEntries; ++i, ++iMade )
+    {
+      manager.addSibling( new MenuEntry<Counter>( g_labels[iMade % g_nLabels], NULL, NULL ) );
+    }
+    if( iLevel + 1 < nLevels )
+    {
+      manager.addChild( new MenuEntry<Counter>( g_labels[iMade % g_nLabels], NULL, NULL ) );
+      ++iMade;
+      manager.MenuSelect();
+    }
+  }
+  manager.SelectRoot();
+  return pRoot;
+}
+
+void FreeMenu( MenuEntry<Counter> *pEntry )
+{
+  while( pEntry != NULL )
+  {
+    MenuEntry<Counter> *pNext = pEntry->getNextSibling();
+    FreeMenu( pEntry->getChild() );
+    delete pEntry;
+    pEntry = pNext;
+  }
+}
+
+void Report( const char *pScript, int nEntries, int nLevels, long lPresses, unsigned long ulMicros )
+{
+  const MenuBusStats &stats = g_counter.getStats();
+  Serial.print( nEntries );
+  Serial.print( ',' );
+  Serial.print( nLevels );
+  Serial.print( ',' );
+  Serial.print( pScript );
+  Serial.print( ',' );
+  Serial.print( lPresses );
+  Serial.print( ',' );
+  Serial.print( stats.commands );
+  Serial.print( ',' );
+  Serial.print( stats.chars );
+  Serial.print( ',' );
+  Serial.print( stats.cursorMoves );
+  Serial.print( ',' );
+  Serial.print( stats.clears );
+  Serial.print( ',' );
+  Serial.print( stats.busMicros / lPresses );
+  Serial.print( ',' );
+  Serial.println( ulMicros / lPresses );
+}
+
+//Each script starts at the root with a freshly drawn menu.
+void RunScript( MenuManager<Counter> &manager, const char *pScript, int nEntries, int nLevels )
+{
+  manager.SelectRoot();
+  manager.DrawMenu();
+  g_counter.resetStats();
+  long lPresses = 0;
+  unsigned long ulStart = micros();
+  if( strcmp( pScript, "scroll" ) == 0 )
+  {
+    //to the end of the top level list and back, one press at a time
+    for( int i = 0; i < nEntries; ++i, ++lPresses )
+    {
+      manager.DoMenuAction( MENU_ACTION_DOWN );
+    }
+    for( int i = 0; i < nEntries; ++i, ++lPresses )
+    {
+      manager.DoMenuAction( MENU_ACTION_UP );
+    }
+  }
+  else if( strcmp( pScript, "dive" ) == 0 )
+  {
+    //into the deepest level and back out, ten times
+    for( int iRound = 0; iRound < 10; ++iRound )
+    {
+      for( int i = 0; i < nLevels; ++i, ++lPresses )
+      {
+        manager.DoMenuAction( MENU_ACTION_SELECT );
+      }
+      for( int i = 0; i < nLevels; ++i, ++lPresses )
+      {
+        manager.DoMenuAction( MENU_ACTION_BACK );
+      }
+    }
+  }
+  else
+  {
+    //a fixed pseudo random walk, the same every run
+    randomSeed( 42 );
+    for( int i = 0; i < 200; ++i, ++lPresses )
+    {
+      manager.DoMenuAction( (MENU_ACTION)random( MENU_ACTION_UP, MENU_ACTION_BACK + 1 ) );
+    }
+  }
+  Report( pScript, nEntries, nLevels, lPresses, micros() - ulStart );
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  Serial.println( "entries,levels,script,presses,commands,chars,cursor,clears,bus_us_per_press,cpu_us_per_press" );
+  const char *pScripts[] = { "scroll", "dive", "random" };
+  for( unsigned int iSize = 0; iSize < sizeof( g_sizes ) / sizeof( g_sizes[0] ); ++iSize )
+  {
+    for( unsigned int iLevels = 0; iLevels < sizeof( g_levels ) / sizeof( g_levels[0] ); ++iLevels )
+    {
+      MenuManager<Counter> manager( &g_menuLCD );
+      //the wipe animation is mostly delay(), leave it out of the numbers
+      manager.setWipeEnabled( false );
+      MenuEntry<Counter> *pRoot = BuildMenu( manager, g_sizes[iSize], g_levels[iLevels] );
+      for( int iScript = 0; iScript < 3; ++iScript )
+      {
+        RunScript( manager, pScripts[iScript], g_sizes[iSize], g_levels[iLevels] );
+      }
+      FreeMenu( pRoot );
+    }
+  }
+  Serial.println( "done" );
+}
+
+void loop()
+{
+}
@@ -0,0 +1,73 @@
+/*
+ Arduino_LCD_Menu Library
+Copyright Dustin Andrews, David Andrews 2012 
+Licensed under the follwing license:
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the 
+following conditions are met:
+
+Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer. 
+Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer 
+in the documentation and/or other materials provided with the distribution. 
+The name of the author may not be used to endorse or promote products derived from this software without specific prior written permission. 
+
+THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, 
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE 
+AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "MenuEntry.h"
+#include "MenuLCD.h"
+#include "MenuManager.h"
+#include "MenuBusCounter.h"
+#include "MenuTrace.h"
+
+//Replays a trace recorded on a device with MenuTrace and printed by MenuTrace::Dump, without an LCD.
+//For every recorded action it prints what the redraw cost on the display bus, then the screen the
+//trace ends on.  Paste the bytes between "menutrace" and "end" into g_trace, and build the same
+//menu as the device did in BuildMenu.  Keep the output of a good run to compare later runs against.
+//
+//If the ring was full when it was dumped, the oldest actions are gone and the trace starts part
+//way through a session, so replay it from the screen the device was on at that time.
+
+typedef MenuBusCounter<MenuNullLCD> Counter;
+
+MenuNullLCD g_nullLCD;
+Counter g_counter( &g_nullLCD );
+MenuLCD<Counter> g_menuLCD( &g_counter, 16, 2 );
+MenuManager<Counter> g_menuManager( &g_menuLCD );
+
+//DOWN, DOWN, UP, SELECT, BACK, then DOWN 300 times in one burst
+const uint8_t g_trace[] = {
+0x02, 0x00, 0x02, 0x46, 0x01, 0x8C, 0x01, 0x03, 0xD2, 0x01, 0x04, 0x98, 0x02, 0x12, 0xE8, 0x07,
+0xAB, 0x02,
+};
+
+void BuildMenu()
+{
+  g_menuManager.addMenuRoot( new MenuEntry<Counter>( "Stopwatch", NULL, NULL ) );
+  g_menuManager.addChild( new MenuEntry<Counter>( "Start", NULL, NULL ) );
+  g_menuManager.addChild( new MenuEntry<Counter>( "Stop", NULL, NULL ) );
+  g_menuManager.addSibling( new MenuEntry<Counter>( "Timer", NULL, NULL ) );
+  g_menuManager.addSibling( new MenuEntry<Counter>( "Credits", NULL, NULL ) );
+  g_menuManager.SelectRoot();
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  BuildMenu();
+  //the replay calls Update() once per action, too seldom to play the wipe, so leave it out of the numbers
+  g_menuManager.setWipeEnabled( false );
+  g_menuManager.DrawMenu();
+  MenuTraceReader reader( g_trace, sizeof( g_trace ) );
+  MenuTraceReplay( reader, g_menuManager, g_menuLCD, g_counter, Serial );
+  Serial.println( "done" );
+}
+
+void loop()
+{
+}